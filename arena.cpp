@@ -0,0 +1,148 @@
+#include "arena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "drawing.hpp"
+
+#if defined(PP_HOST) && defined(__linux__)
+#include <sys/mman.h>
+#define HAS_HUGE_PAGES
+#define HUGE_PAGE_SIZE (2L * 1024 * 1024)
+#endif
+
+long frame_buffer_span() {
+  // In long: a DOS frame is more than an int holds
+  long const size = static_cast<long>(SCREEN_WIDTH) * SCREEN_HEIGHT +
+                    FRAME_GUARD_SIZE + SCREEN_HEIGHT;
+  return arena_span(FRAME_GUARD_SIZE) + arena_span(size);
+}
+
+static void out_of_memory() {
+  std::cerr << "Not enough memory for the frame arena.\n";
+  std::exit(1);
+}
+
+#ifdef PP_HOST
+typedef std::uintptr_t Address;
+#else
+typedef unsigned long Address; // segment and offset, the offset the low word
+#endif
+
+static std::uint8_t *align(std::uint8_t *const p) {
+  unsigned const misalignment =
+      static_cast<unsigned>(reinterpret_cast<Address>(p) % ARENA_ALIGN);
+  return misalignment ? p + (ARENA_ALIGN - misalignment) : p;
+}
+
+#ifdef PP_HOST
+
+static std::uint8_t *g_block; // as allocated, NULL if mapped
+static std::uint8_t *g_base;
+static long g_size;
+static long g_used;
+
+#ifdef HAS_HUGE_PAGES
+static long g_mapped_size;
+
+// Maps the arena with huge pages, reserved ones if there are any and
+// transparent ones if not. Returns false if neither can be had.
+static bool map_huge_pages(long const size) {
+  g_mapped_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+  void *p = mmap(NULL, g_mapped_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p == MAP_FAILED) {
+    p = mmap(NULL, g_mapped_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      return false;
+
+    if (madvise(p, g_mapped_size, MADV_HUGEPAGE)) {
+      std::cerr << "No huge pages to be had, using small ones\n";
+    }
+  }
+
+  g_base = static_cast<std::uint8_t *>(p);
+  return true;
+}
+#endif
+
+void start_arena(long const size) {
+  g_size = size;
+  g_used = 0;
+  g_block = NULL;
+
+#ifdef HAS_HUGE_PAGES
+  char const *const env = std::getenv("PP_HUGE_PAGES");
+  if (env && std::atoi(env) && map_huge_pages(size))
+    return;
+#endif
+
+  // Mapped memory is already zeroed and aligned to a page
+  if ((g_block = new std::uint8_t[size + ARENA_ALIGN - 1]) == NULL) {
+    out_of_memory();
+  }
+  std::memset(g_block, 0, size + ARENA_ALIGN - 1);
+  g_base = align(g_block);
+}
+
+void stop_arena() {
+#ifdef HAS_HUGE_PAGES
+  if (!g_block && g_base) {
+    munmap(g_base, g_mapped_size);
+  }
+#endif
+  delete[] g_block;
+  g_block = NULL;
+  g_base = NULL;
+}
+
+void *arena_alloc(long const size) {
+  long const span = arena_span(size);
+  if (g_used + span > g_size) {
+    out_of_memory();
+  }
+
+  std::uint8_t *const p = g_base + g_used;
+  g_used += span;
+  return p;
+}
+
+#else
+
+#define ARENA_MAX_BLOCKS 8
+
+// Each piece is a block of its own, which is zeroed when it is allocated
+static std::uint8_t *g_blocks[ARENA_MAX_BLOCKS];
+static int g_num_blocks;
+
+void start_arena(long const) { g_num_blocks = 0; }
+
+void stop_arena() {
+  for (int i = 0; i < g_num_blocks; i++) {
+    delete[] g_blocks[i];
+  }
+  g_num_blocks = 0;
+}
+
+void *arena_alloc(long const size) {
+  long const allocated = size + ARENA_ALIGN - 1;
+  std::uint8_t *block;
+  if (g_num_blocks == ARENA_MAX_BLOCKS || allocated > 0xFFFFL ||
+      (block = new std::uint8_t[static_cast<unsigned>(allocated)]) == NULL) {
+    out_of_memory();
+  }
+  std::memset(block, 0, static_cast<unsigned>(allocated));
+  g_blocks[g_num_blocks++] = block;
+  return align(block);
+}
+
+#endif
+
+std::uint8_t *alloc_frame_buffer() {
+  std::uint8_t *const p =
+      static_cast<std::uint8_t *>(arena_alloc(frame_buffer_span()));
+  return p + arena_span(FRAME_GUARD_SIZE);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Frame arena
+ *
+ * The frame buffers, the blur's tables and the draw lists are carved out of one
+ * block allocated at startup, each piece starting on an ARENA_ALIGN boundary,
+ * so they share no cache line and every row starts on one when SCREEN_WIDTH is
+ * a multiple of it, as all the usual widths are. A frame buffer sits between
+ * two zeroed guards of FRAME_GUARD_SIZE, so the reads of a pixel's neighbours
+ * and the SIMD loads that run past either end of the frame stay in memory that
+ * reads as clear, whatever the zoom tables point at.
+ *
+ * The stride stays SCREEN_WIDTH. Mode 0x13, the present and the capture take a
+ * frame as one block, so a pixel's left neighbour on the first column is the
+ * last pixel of the row above rather than a guard column.
+ *
+ * On DOS each piece is its own allocation, as the compact model can't hold
+ * more than 64K in one. On Linux hosts, setting PP_HUGE_PAGES backs the arena
+ * with huge pages, which saves the blur a TLB miss every few rows at large
+ * sizes.
+ */
+
+#define ARENA_ALIGN 64
+
+// What a piece of size bytes takes up in the arena
+inline long arena_span(long const size) {
+  return (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+// What alloc_frame_buffer() takes up in the arena, guards included
+long frame_buffer_span();
+
+// Allocates an arena of size bytes. Call once the screen size is known.
+void start_arena(long const size);
+void stop_arena();
+
+// size zeroed bytes, aligned to ARENA_ALIGN. Exits if the arena is full.
+// Allocate at startup: it isn't thread safe.
+void *arena_alloc(long const size);
+
+// A zeroed frame buffer of FRAME_BUFFER_SIZE with a guard in front
+std::uint8_t *alloc_frame_buffer();
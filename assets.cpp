@@ -0,0 +1,211 @@
+#include "assets.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef PP_HOST
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::uint8_t;
+
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+#define GLYPHS_SIZE ((long)NUM_GLYPHS * GLYPH_HEIGHT)
+#define PACKED_PALETTE_SIZE ((long)sizeof(PackedPalette) + PALETTE_SIZE)
+
+int num_palettes;
+PackedPalette const *palette_defs;
+uint8_t const *palette_bank;
+Glyph const *glyphs;
+
+static uint8_t *g_builtin_pack = NULL;
+#ifdef PP_HOST
+static void *g_mapping = NULL;
+static std::size_t g_mapping_size;
+#else
+static uint8_t *g_file_pack = NULL;
+#endif
+
+static std::uint32_t checksum(uint8_t const *data, long size) {
+  std::uint32_t hash = FNV_OFFSET_BASIS;
+  while (size--) {
+    hash = (hash ^ *data++) * FNV_PRIME;
+  }
+  return hash;
+}
+
+inline long pack_size(long const count) {
+  return sizeof(PackHeader) + GLYPHS_SIZE + count * PACKED_PALETTE_SIZE;
+}
+
+// True if size bytes can be allocated and addressed as one block
+inline bool fits_in_block(long const size) {
+  return static_cast<long>(static_cast<std::size_t>(size)) == size;
+}
+
+uint8_t *build_pack(PaletteDef const *const defs, int const count,
+                    long &size) {
+  size = pack_size(count);
+  if (count <= 0 || count > 0xFFFF || !fits_in_block(size))
+    return NULL;
+
+  uint8_t *const data = new uint8_t[static_cast<std::size_t>(size)];
+  if (data == NULL)
+    return NULL;
+  std::memset(data, 0, static_cast<std::size_t>(size));
+
+  uint8_t *const font = data + sizeof(PackHeader);
+  std::memcpy(font, font_glyphs, GLYPHS_SIZE);
+
+  PackedPalette *const packed =
+      reinterpret_cast<PackedPalette *>(font + GLYPHS_SIZE);
+  uint8_t *const bank = reinterpret_cast<uint8_t *>(packed + count);
+  for (int i = 0; i < count; i++) {
+    packed[i].num_ranges = static_cast<uint8_t>(defs[i].num_ranges);
+    packed[i].is_noisy = defs[i].is_noisy ? 1 : 0;
+    std::memcpy(packed[i].ranges, defs[i].ranges, sizeof(packed[i].ranges));
+    build_palette(defs[i], bank + static_cast<long>(i) * PALETTE_SIZE);
+  }
+
+  PackHeader *const header = reinterpret_cast<PackHeader *>(data);
+  std::memcpy(header->magic, PACK_MAGIC, PACK_MAGIC_SIZE);
+  header->version = PACK_VERSION;
+  header->num_palettes = static_cast<std::uint16_t>(count);
+  header->size = static_cast<std::uint32_t>(size);
+  header->checksum = checksum(font, size - sizeof(PackHeader));
+  return data;
+}
+
+PackHeader const *check_pack(uint8_t const *const data, long const size) {
+  if (size < static_cast<long>(sizeof(PackHeader)))
+    return NULL;
+
+  PackHeader const *const header = reinterpret_cast<PackHeader const *>(data);
+  if (std::memcmp(header->magic, PACK_MAGIC, PACK_MAGIC_SIZE) != 0 ||
+      header->version != PACK_VERSION || header->num_palettes == 0 ||
+      header->size != static_cast<std::uint32_t>(size) ||
+      pack_size(header->num_palettes) != size ||
+      header->checksum != checksum(data + sizeof(PackHeader),
+                                   size - sizeof(PackHeader)))
+    return NULL;
+
+  return header;
+}
+
+static void use_pack(PackHeader const *const header) {
+  uint8_t const *const font =
+      reinterpret_cast<uint8_t const *>(header) + sizeof(PackHeader);
+
+  num_palettes = header->num_palettes;
+  glyphs = reinterpret_cast<Glyph const *>(font);
+  palette_defs = reinterpret_cast<PackedPalette const *>(font + GLYPHS_SIZE);
+  palette_bank =
+      reinterpret_cast<uint8_t const *>(palette_defs + num_palettes);
+}
+
+#ifdef PP_HOST
+// Maps the file read-only. The pages are only read once, by the checksum.
+static uint8_t const *open_pack(char const *const path, long &size) {
+  int const fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  struct stat info;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    size = 0; // exists but can't be used
+    return NULL;
+  }
+
+  g_mapping = data;
+  g_mapping_size = info.st_size;
+  size = info.st_size;
+  return static_cast<uint8_t const *>(data);
+}
+
+static void close_pack() {
+  if (g_mapping) {
+    munmap(g_mapping, g_mapping_size);
+    g_mapping = NULL;
+  }
+}
+#else
+static void close_pack() {
+  delete[] g_file_pack;
+  g_file_pack = NULL;
+}
+
+// No mapping under DOS, so read it in one go instead.
+static uint8_t const *open_pack(char const *const path, long &size) {
+  std::FILE *const file = std::fopen(path, "rb");
+  if (file == NULL)
+    return NULL;
+
+  size = 0; // exists but can't be used
+  long length = -1;
+  if (std::fseek(file, 0, SEEK_END) == 0) {
+    length = std::ftell(file);
+    std::rewind(file);
+  }
+
+  if (length > 0 && fits_in_block(length) &&
+      (g_file_pack = new uint8_t[static_cast<std::size_t>(length)]) != NULL &&
+      std::fread(g_file_pack, 1, static_cast<std::size_t>(length), file) ==
+          static_cast<std::size_t>(length)) {
+    size = length;
+  }
+  std::fclose(file);
+
+  if (!size) {
+    close_pack();
+  }
+  return g_file_pack;
+}
+#endif
+
+void load_assets(char const *const path, bool const is_required) {
+  long size = -1; // stays negative if the file doesn't exist
+  uint8_t const *const data = open_pack(path, size);
+
+  if (data) {
+    if (PackHeader const *const header = check_pack(data, size)) {
+      use_pack(header);
+      return;
+    }
+    close_pack();
+    size = 0;
+  }
+
+  if (size >= 0) {
+    std::cerr << path << " is not a version " << PACK_VERSION
+              << " asset pack, using built-in assets\n";
+  } else if (is_required) {
+    std::cerr << "Unable to open asset pack " << path
+              << ", using built-in assets\n";
+  }
+
+  if ((g_builtin_pack = build_pack(palettes, NUM_PALETTES, size)) == NULL) {
+    std::cerr << "Not enough memory for assets.\n";
+    std::exit(1);
+  }
+  use_pack(reinterpret_cast<PackHeader const *>(g_builtin_pack));
+}
+
+void unload_assets() {
+  close_pack();
+  delete[] g_builtin_pack;
+  g_builtin_pack = NULL;
+}
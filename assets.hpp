@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include "palettes.hpp"
+#include "sprites.hpp"
+#include "system.hpp"
+
+/*
+ * Asset pack
+ *
+ * The palettes, with their gamma-corrected DAC tables already computed, and
+ * the font live in one binary file. Every field is a byte or a fixed-width
+ * integer, so the file is used exactly as it sits in memory: it is mapped (or
+ * read in one go on DOS), checksummed and pointed into, with nothing to parse
+ * or compute.
+ *
+ * Layout, little-endian:
+ *
+ *   PackHeader
+ *   font            NUM_GLYPHS * GLYPH_HEIGHT bytes, as in sprites.hpp
+ *   PackedPalette   num_palettes of them
+ *   DAC tables      num_palettes * PALETTE_SIZE bytes
+ *
+ * Build one with mkpack.cpp. Without a pack the game uses the data compiled
+ * into it.
+ */
+
+#define PACK_MAGIC "PPAK"
+#define PACK_MAGIC_SIZE 4
+#define PACK_VERSION 2
+#define DEFAULT_PACK_PATH "pp.dat"
+
+#define PALETTE_SIZE (NUM_COLORS * 3)
+
+struct PackHeader {
+  char magic[PACK_MAGIC_SIZE];
+  std::uint16_t version;
+  std::uint16_t num_palettes;
+  std::uint32_t size;     // of the whole pack, header included
+  std::uint32_t checksum; // FNV-1a of everything after the header
+};
+
+// A PaletteDef with no int or bool, so it has the same layout everywhere
+struct PackedPalette {
+  std::uint8_t num_ranges;
+  std::uint8_t is_noisy;
+  PaletteRange ranges[MAX_PALETTE_RANGES];
+};
+
+typedef std::uint8_t Glyph[GLYPH_HEIGHT];
+
+// Set by load_assets()
+extern int num_palettes;
+extern PackedPalette const *palette_defs;
+extern std::uint8_t const *palette_bank; // PALETTE_SIZE bytes per palette
+extern Glyph const *glyphs; // from FIRST_GLYPH to LAST_GLYPH
+
+// Builds a pack in memory from palette definitions and the built-in font.
+// Returns NULL if it would be too large. Free it with delete[].
+std::uint8_t *build_pack(PaletteDef const *const defs, int const count,
+                         long &size);
+
+// Returns NULL if data isn't a valid, complete pack.
+PackHeader const *check_pack(std::uint8_t const *const data, long const size);
+
+// Uses the pack at path, or the built-in data if it is missing or invalid.
+// Only complains about a missing file if is_required.
+void load_assets(char const *const path, bool const is_required);
+void unload_assets();
@@ -0,0 +1,260 @@
+/*
+ * Plays many games at once, each with a bot at the controls, for soak tests
+ * and tuning. Host tool, not part of the game.
+ *
+ *   g++ -std=c++11 -O2 -DNDEBUG -Ihost -o ppbatch batch.cpp game.cpp bot.cpp
+ *       blur.cpp blur_simd.cpp drawing.cpp drawlist.cpp effects.cpp
+ *       particle.cpp rnd.cpp tables.cpp assets.cpp palettes.cpp sprites.cpp
+ *       workers.cpp host_system.cpp capture.cpp present.cpp feedback.cpp
+ *       arena.cpp -pthread
+ *   ./ppbatch [--games N] [--ticks N] [--render N] [--seed N] [--threads N]
+ *             [--particles N] [--size WxH]
+ *
+ * Game i starts from seed + i (--seed defaults to 15) and runs --ticks ticks,
+ * a minute of play by default. The first --render games (default 0) also draw
+ * a frame after every tick into buffers and a view of their own, allocated up
+ * front from the frame arena; the rest only simulate.
+ * Games are tasks on the worker pool, which hands the next one to whichever
+ * thread is free, so a slow game doesn't hold up the others. Each game writes
+ * only its own result, and the results are merged in order, so the report is
+ * the same for any thread count.
+ *
+ * The report gives ticks/sec over all threads, how many rounds were lost and
+ * the distribution of the score each one reached, the distribution of each
+ * game's best round, and a checksum of where every game ended up.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "arena.hpp"
+#include "assets.hpp"
+#include "blur.hpp"
+#include "bot.hpp"
+#include "game.hpp"
+#include "system.hpp"
+#include "workers.hpp"
+
+#define DEFAULT_GAMES 1024
+#define DEFAULT_TICKS (70L * 60)
+#define NUM_SCORE_BINS 256 // the last one holds every score above it
+
+typedef std::chrono::steady_clock Clock;
+
+struct GameResult {
+  long rounds; // lost
+  int best;    // highest score a round reached, lost or not
+  long scores[NUM_SCORE_BINS]; // rounds lost with each score
+  std::uint32_t checksum;
+};
+
+struct Batch {
+  int num_games;
+  long num_ticks;
+  int num_rendered;
+  std::uint32_t seed;
+  int num_particles;
+  std::vector<GameResult> results;
+  std::vector<std::uint8_t *> buffers; // two per drawn game
+  std::vector<GameView> views;          // one per drawn game
+};
+
+static std::uint32_t add_hash(std::uint32_t hash, std::uint32_t const value) {
+  // FNV-1a, a byte at a time
+  for (int i = 0; i < 4; i++) {
+    hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 16777619UL;
+  }
+  return hash;
+}
+
+static void play_game(void *const context, int const index) {
+  Batch &batch = *static_cast<Batch *>(context);
+  GameResult &result = batch.results[index];
+  std::memset(&result, 0, sizeof(result));
+
+  std::uint32_t const seed = batch.seed + static_cast<std::uint32_t>(index);
+  Game game;
+  init_game(game, batch.num_particles);
+  start_game(game, seed, NUM_FEEDBACKS);
+
+  Bot bot;
+  init_bot(bot, seed);
+  MouseState mouse;
+
+  bool const is_rendered = index < batch.num_rendered;
+  GameView *view = NULL;
+  std::uint8_t *front = NULL;
+  std::uint8_t *back = NULL;
+  if (is_rendered) {
+    view = &batch.views[index];
+    front = batch.buffers[2 * index];
+    back = batch.buffers[2 * index + 1];
+  }
+
+  for (long tick = 0; tick < batch.num_ticks; tick++) {
+    get_bot_input(bot, game.g, mouse);
+    State const state = game.state;
+    run_tick(game, mouse);
+
+    result.best = std::max(result.best, game.g.score);
+    if (state == kPlaying && game.state == kLosing) {
+      result.rounds++;
+      result.scores[std::min(game.g.score, NUM_SCORE_BINS - 1)]++;
+    }
+
+    if (is_rendered) {
+      render_game(*view, game, mouse, front, back);
+      std::swap(front, back);
+    }
+  }
+
+  std::uint32_t hash = 2166136261UL;
+  hash = add_hash(hash, static_cast<std::uint32_t>(game.state));
+  hash = add_hash(hash, static_cast<std::uint32_t>(game.g.score));
+  hash = add_hash(hash, static_cast<std::uint32_t>(game.g.ball_x));
+  hash = add_hash(hash, static_cast<std::uint32_t>(game.g.ball_y));
+  if (is_rendered) {
+    // The last frame drawn, which the swap left in back
+    long const size = static_cast<long>(SCREEN_WIDTH) * SCREEN_HEIGHT;
+    for (long i = 0; i < size; i++) {
+      hash = (hash ^ back[i]) * 16777619UL;
+    }
+  }
+  result.checksum = hash;
+
+  free_game(game);
+}
+
+// The smallest value with at least percent of the counts at or below it
+static int percentile(std::vector<long> const &counts, long const total,
+                      int const percent) {
+  long const rank = (total * percent + 99) / 100;
+  long seen = 0;
+  for (std::size_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= rank && seen > 0)
+      return static_cast<int>(i);
+  }
+  return static_cast<int>(counts.size()) - 1;
+}
+
+static void print_distribution(char const *const name,
+                               std::vector<long> const &counts) {
+  long total = 0;
+  double sum = 0;
+  int max = 0;
+  for (std::size_t i = 0; i < counts.size(); i++) {
+    total += counts[i];
+    sum += static_cast<double>(counts[i]) * i;
+    if (counts[i]) {
+      max = static_cast<int>(i);
+    }
+  }
+
+  std::printf("%s: %ld, mean %.2f, p10 %d, p50 %d, p90 %d, p99 %d, max %d%s\n",
+              name, total, total ? sum / total : 0.0,
+              percentile(counts, total, 10), percentile(counts, total, 50),
+              percentile(counts, total, 90), percentile(counts, total, 99),
+              max, max == NUM_SCORE_BINS - 1 ? " or more" : "");
+}
+
+int main(int argc, char *argv[]) {
+  Batch batch;
+  batch.num_games = DEFAULT_GAMES;
+  batch.num_ticks = DEFAULT_TICKS;
+  batch.num_rendered = 0;
+  batch.seed = DEFAULT_SEED;
+  batch.num_particles = NEBULA_PARTICLES;
+  int threads = 0;
+
+  // Our own options come out of argv; the backend gets the rest (--size)
+  int kept = 1;
+  for (int i = 1; i < argc; i++) {
+    bool const has_value = i + 1 < argc;
+
+    if (!std::strcmp(argv[i], "--games") && has_value) {
+      batch.num_games = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--ticks") && has_value) {
+      batch.num_ticks = std::atol(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--render") && has_value) {
+      batch.num_rendered = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--seed") && has_value) {
+      batch.seed =
+          static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 0));
+    } else if (!std::strcmp(argv[i], "--threads") && has_value) {
+      threads = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--particles") && has_value) {
+      batch.num_particles = std::atoi(argv[++i]);
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argv[kept] = NULL;
+
+  if (!init_system(kept, argv) || batch.num_games < 1 ||
+      batch.num_ticks < 0 || batch.num_particles < 0) {
+    std::cerr << "batch options: [--games N] [--ticks N] [--render N]"
+                 " [--seed N] [--threads N] [--particles N]\n";
+    return 1;
+  }
+
+  int const num_rendered = std::max(0, std::min(batch.num_rendered,
+                                                batch.num_games));
+  start_arena(num_rendered * (2L * frame_buffer_span() +
+                              view_arena_size(batch.num_particles)) +
+              blur_arena_size());
+  for (int i = 0; i < 2 * num_rendered; i++) {
+    batch.buffers.push_back(alloc_frame_buffer());
+  }
+  // Here, as the arena is for one thread at a time
+  batch.views.resize(num_rendered);
+  for (int i = 0; i < num_rendered; i++) {
+    init_view(batch.views[i], batch.num_particles,
+              batch.seed + static_cast<std::uint32_t>(i));
+  }
+
+  init_blur();
+  load_assets(DEFAULT_PACK_PATH, false);
+  start_workers(threads);
+  batch.results.resize(batch.num_games);
+
+  Clock::time_point const start = Clock::now();
+  run_tasks(play_game, &batch, batch.num_games);
+  double const seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<long> scores(NUM_SCORE_BINS, 0);
+  std::vector<long> bests(NUM_SCORE_BINS, 0);
+  std::uint32_t checksum = 2166136261UL;
+  for (int i = 0; i < batch.num_games; i++) {
+    GameResult const &result = batch.results[i];
+    for (int score = 0; score < NUM_SCORE_BINS; score++) {
+      scores[score] += result.scores[score];
+    }
+    bests[std::min(result.best, NUM_SCORE_BINS - 1)]++;
+    checksum = add_hash(checksum, result.checksum);
+  }
+
+  double const ticks = static_cast<double>(batch.num_ticks) * batch.num_games;
+  std::printf("batch: %d games (%d drawn) x %ld ticks on %d threads in %.3f "
+              "s, %.0f ticks/sec\n",
+              batch.num_games, std::min(batch.num_rendered, batch.num_games),
+              batch.num_ticks, num_workers(), seconds,
+              seconds > 0 ? ticks / seconds : 0.0);
+  print_distribution("rounds lost", scores);
+  print_distribution("best per game", bests);
+  std::printf("checksum %08x\n", static_cast<unsigned>(checksum));
+
+  for (int i = 0; i < num_rendered; i++) {
+    free_view(batch.views[i]);
+  }
+  stop_workers();
+  unload_assets();
+  stop_arena();
+  return 0;
+}
@@ -0,0 +1,492 @@
+/*
+ * Times the rendering kernels one at a time. Host tool, not part of the game.
+ *
+ *   g++ -std=c++11 -O2 -DNDEBUG -Ihost -o ppbench bench.cpp blur.cpp
+ *       blur_simd.cpp drawing.cpp drawlist.cpp effects.cpp rnd.cpp tables.cpp
+ *       assets.cpp palettes.cpp sprites.cpp workers.cpp host_system.cpp
+ *       capture.cpp present.cpp feedback.cpp arena.cpp -pthread
+ *   ./ppbench [--kernel PREFIX] [--threads N] [--batch-ms N] [--size WxH]
+ *
+ * Every kernel draws a fixed set of cases, picked with a fixed seed, onto a
+ * synthetic plasma frame: a few sine waves run through blur() until they look
+ * like the game's. Each case is run the same way every time, so two builds
+ * can be compared kernel by kernel.
+ *
+ * Output is CSV on stdout, one line per kernel. pixels is what one call writes
+ * on average (palette entries for the palette kernels), counted by drawing
+ * each case on its own before timing. Times are the best of BATCHES batches
+ * of at least --batch-ms each (default 5). Cycles are those of the time stamp
+ * counter, which on most CPUs runs at the base clock whatever the core does.
+ * blur() honours PP_BLUR, and --threads (default 1) sizes the worker pool it
+ * and the draw lists run on. blur_map_* blur through each 2D feedback map,
+ * blur_map_zoom being the separable zoom's as a 2D map, and map_build_* build
+ * one whole.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER
+#endif
+
+#include "arena.hpp"
+#include "assets.hpp"
+#include "blur.hpp"
+#include "drawing.hpp"
+#include "drawlist.hpp"
+#include "effects.hpp"
+#include "feedback.hpp"
+#include "palettes.hpp"
+#include "rnd.hpp"
+#include "system.hpp"
+#include "workers.hpp"
+
+#define NUM_CASES 64 // per kernel, except blur and the palettes
+#define BATCHES 9
+#define PLASMA_SEED 0x6A09E667UL
+#define PLASMA_PASSES 12 // blurs that turn the sine waves into plasma
+
+typedef std::chrono::steady_clock Clock;
+
+struct Kernel {
+  char const *name;
+  void (*run)(uint8_t *const buffer, int const param, int const i);
+  int param;
+  int num_cases;
+  long pixels; // per call, or 0 to count them
+};
+
+// Frame buffers from the arena, like the game's
+#define BENCH_FRAMES 4
+
+static uint8_t *g_plasma;     // the blur source
+static uint8_t *g_frame;      // what the other kernels draw on
+static uint8_t *g_blur_frame; // what blur() writes
+static DrawList g_overlay;            // empty, for blur()
+static DrawList g_list;               // the effects'
+static FeedbackMap g_maps[kNumFeedbackKinds]; // all 2D, the zoom included
+static uint8_t g_rgb[NUM_COLORS * 3];
+
+static Rnd g_case_rnd = {PLASMA_SEED, 0};
+static Rnd g_effect_rnd; // case i draws from its i-th substream
+
+static int random_below(int const limit) {
+  return static_cast<int>(next_rnd32(g_case_rnd) %
+                          static_cast<std::uint32_t>(limit));
+}
+
+static int random_between(int const low, int const high) {
+  return low + random_below(high - low + 1);
+}
+
+/*
+ * Cases
+ */
+
+static Segment g_octant_lines[8][NUM_CASES];
+static Segment g_clipped_lines[NUM_CASES];
+
+struct Span {
+  int x, y, size;
+};
+
+static Span g_spans[NUM_CASES];
+static Span g_clipped_spans[NUM_CASES];
+
+static long g_numbers[NUM_CASES];
+static int g_number_x[NUM_CASES];
+static int g_number_y[NUM_CASES];
+
+static void make_cases() {
+  int const reach = std::min(SCREEN_WIDTH, SCREEN_HEIGHT) / 4;
+
+  // Octant bit 0 makes y the major axis, bits 1 and 2 flip x and y
+  for (int octant = 0; octant < 8; octant++) {
+    for (int i = 0; i < NUM_CASES; i++) {
+      int const major = random_between(reach / 4, reach);
+      int const minor = random_below(major + 1);
+      int dx = octant & 1 ? minor : major;
+      int dy = octant & 1 ? major : minor;
+      if (octant & 2) {
+        dx = -dx;
+      }
+      if (octant & 4) {
+        dy = -dy;
+      }
+
+      Segment &segment = g_octant_lines[octant][i];
+      segment.x1 = MID_X + random_between(-reach, reach);
+      segment.y1 = MID_Y + random_between(-reach, reach);
+      segment.x2 = segment.x1 + dx;
+      segment.y2 = segment.y1 + dy;
+    }
+  }
+
+  // From well off one edge to well off another, through the screen or not
+  for (int i = 0; i < NUM_CASES; i++) {
+    Segment &segment = g_clipped_lines[i];
+    segment.x1 = random_between(-SCREEN_WIDTH / 2, SCREEN_WIDTH * 3 / 2);
+    segment.y1 = random_between(-SCREEN_HEIGHT / 2, SCREEN_HEIGHT * 3 / 2);
+    segment.x2 = random_between(-SCREEN_WIDTH / 2, SCREEN_WIDTH * 3 / 2);
+    segment.y2 = random_between(-SCREEN_HEIGHT / 2, SCREEN_HEIGHT * 3 / 2);
+  }
+
+  for (int i = 0; i < NUM_CASES; i++) {
+    Span &span = g_spans[i];
+    span.x = random_below(SCREEN_WIDTH);
+    span.y = random_below(SCREEN_HEIGHT);
+    span.size = random_between(1, SCREEN_WIDTH - span.x);
+
+    Span &clipped = g_clipped_spans[i];
+    clipped.x = random_between(-SCREEN_WIDTH / 2, MAX_X);
+    clipped.y = random_between(-SCREEN_HEIGHT / 4, SCREEN_HEIGHT * 5 / 4);
+    clipped.size = random_between(1, SCREEN_WIDTH);
+  }
+
+  // One to seven digits, like the score
+  for (int i = 0; i < NUM_CASES; i++) {
+    long limit = 10;
+    for (int digits = i % 7; digits > 0; digits--) {
+      limit *= 10;
+    }
+    g_numbers[i] = random_below(static_cast<int>(limit));
+    g_number_x[i] = random_below(SCREEN_WIDTH - 8 * GLYPH_SPACING);
+    g_number_y[i] = random_below(SCREEN_HEIGHT - GLYPH_HEIGHT);
+  }
+}
+
+// Sine waves, blurred into the soft gradients the game shows
+static void make_plasma() {
+  uint8_t *other = alloc_frame_buffer();
+
+  double frequencies[3][2];
+  double phases[3];
+  for (int wave = 0; wave < 3; wave++) {
+    frequencies[wave][0] = random_between(2, 9) * 3.14159265 / SCREEN_WIDTH;
+    frequencies[wave][1] = random_between(2, 9) * 3.14159265 / SCREEN_HEIGHT;
+    phases[wave] = random_below(628) / 100.0;
+  }
+
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+      double sum = 0;
+      for (int wave = 0; wave < 3; wave++) {
+        sum += std::sin(x * frequencies[wave][0] + y * frequencies[wave][1] +
+                        phases[wave]);
+      }
+      g_plasma[INDEX_OF(x, y)] =
+          static_cast<uint8_t>((sum + 3) / 6 * MAX_COLOR);
+    }
+    mark_row(g_plasma, y);
+  }
+
+  for (int pass = 0; pass < PLASMA_PASSES; pass++) {
+    blur<false>(other, g_plasma, 0, g_overlay, NULL);
+    std::swap(g_plasma, other);
+  }
+  std::memcpy(g_frame, g_plasma, FRAME_BUFFER_SIZE);
+}
+
+/*
+ * Kernels
+ */
+
+static void run_blur(uint8_t *const buffer, int const is_noisy, int const i) {
+  std::uint32_t const seed = static_cast<std::uint32_t>(i);
+  if (is_noisy) {
+    blur<true>(buffer, g_plasma, seed, g_overlay, NULL);
+  } else {
+    blur<false>(buffer, g_plasma, seed, g_overlay, NULL);
+  }
+}
+
+static void run_blur_map(uint8_t *const buffer, int const kind, int const i) {
+  blur<false>(buffer, g_plasma, static_cast<std::uint32_t>(i), g_overlay,
+              &g_maps[kind]);
+}
+
+// Somewhere off the middle, like the ball
+#define BENCH_MAP_X (SCREEN_WIDTH / 3)
+#define BENCH_MAP_Y (SCREEN_HEIGHT / 4)
+
+static void run_build_map(uint8_t *const, int const kind, int) {
+  build_feedback_map(g_maps[kind], kind, BENCH_MAP_X, BENCH_MAP_Y);
+}
+
+static void run_line(uint8_t *const buffer, int const octant, int const i) {
+  Segment const &segment = g_octant_lines[octant][i];
+  line(buffer, segment.x1, segment.y1, segment.x2, segment.y2, 200);
+}
+
+static void run_clipped_line(uint8_t *const buffer, int, int const i) {
+  Segment const &segment = g_clipped_lines[i];
+  line(buffer, segment.x1, segment.y1, segment.x2, segment.y2, 200);
+}
+
+static void run_set_pixels(uint8_t *const buffer, int, int const i) {
+  Span const &span = g_spans[i];
+  set_pixels(buffer, span.x, span.y, 200, span.size);
+}
+
+static void run_set_pixels_clipped(uint8_t *const buffer, int, int const i) {
+  Span const &span = g_clipped_spans[i];
+  set_pixels_clipped(buffer, span.x, span.y, 200, span.size);
+}
+
+static void run_draw_number(uint8_t *const buffer, int, int const i) {
+  // A new number every call, so the layout is timed along with the blit
+  static TextRun run;
+  draw_number(buffer, g_number_x[i], g_number_y[i], g_numbers[i], run);
+}
+
+static void run_build_palette(uint8_t *, int, int const i) {
+  build_palette(palettes[i % NUM_PALETTES], g_rgb);
+}
+
+static void run_upload_palette(uint8_t *, int, int) {
+  set_palette_block(0, NUM_COLORS, g_rgb);
+}
+
+static void run_effect(uint8_t *const buffer, int const effect, int const i) {
+  Rnd rnd = split_rnd(g_effect_rnd, i);
+  clear_draw_list(g_list);
+  effects[effect](g_list, rnd);
+  draw_list(g_list, buffer);
+}
+
+static std::vector<Kernel> make_kernels() {
+  static char names[8 + NUM_EFFECTS + 2 * kNumFeedbackKinds][32];
+  std::vector<Kernel> kernels;
+
+  Kernel const blur_clean = {"blur_clean", run_blur, 0, NUM_CASES,
+                             static_cast<long>(SCREEN_SIZE)};
+  Kernel const blur_noisy = {"blur_noisy", run_blur, 1, NUM_CASES,
+                             static_cast<long>(SCREEN_SIZE)};
+  kernels.push_back(blur_clean);
+  kernels.push_back(blur_noisy);
+
+  // Both write a whole frame: the maps' displacements, or the blur
+  for (int kind = 0; kind < kNumFeedbackKinds; kind++) {
+    char *const name = names[8 + NUM_EFFECTS + kind];
+    std::sprintf(name, "blur_map_%s", feedback_names[kind]);
+    Kernel const kernel = {name, run_blur_map, kind, NUM_CASES,
+                           static_cast<long>(SCREEN_SIZE)};
+    kernels.push_back(kernel);
+  }
+  for (int kind = 0; kind < kNumFeedbackKinds; kind++) {
+    char *const name = names[8 + NUM_EFFECTS + kNumFeedbackKinds + kind];
+    std::sprintf(name, "map_build_%s", feedback_names[kind]);
+    Kernel const kernel = {name, run_build_map, kind, 1,
+                           static_cast<long>(SCREEN_SIZE)};
+    kernels.push_back(kernel);
+  }
+
+  for (int octant = 0; octant < 8; octant++) {
+    std::sprintf(names[octant], "line_octant%d", octant);
+    Kernel const kernel = {names[octant], run_line, octant, NUM_CASES, 0};
+    kernels.push_back(kernel);
+  }
+
+  Kernel const others[] = {
+      {"line_clipped", run_clipped_line, 0, NUM_CASES, 0},
+      {"set_pixels", run_set_pixels, 0, NUM_CASES, 0},
+      {"set_pixels_clipped", run_set_pixels_clipped, 0, NUM_CASES, 0},
+      {"draw_number", run_draw_number, 0, NUM_CASES, 0},
+      {"palette_build", run_build_palette, 0, NUM_PALETTES, NUM_COLORS},
+      {"palette_upload", run_upload_palette, 0, 1, NUM_COLORS},
+  };
+  kernels.insert(kernels.end(), others,
+                 others + sizeof(others) / sizeof(Kernel));
+
+  for (int effect = 0; effect < NUM_EFFECTS; effect++) {
+    std::sprintf(names[8 + effect], "effect_%s", effect_names[effect]);
+    Kernel const kernel = {names[8 + effect], run_effect, effect, NUM_CASES, 0};
+    kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+/*
+ * Measuring
+ */
+
+// Pixels the kernel writes per call on average. Each case is drawn on two
+// blank frames of different colors, so a pixel drawn in either color counts.
+static double count_pixels(Kernel const &kernel) {
+  static uint8_t const backgrounds[2] = {0, 0xFF};
+  std::vector<uint8_t> scratch(FRAME_BUFFER_SIZE);
+  std::vector<uint8_t> is_drawn(SCREEN_SIZE, 0);
+  std::vector<uint8_t> is_row_drawn(SCREEN_HEIGHT, 0);
+
+  long total = 0;
+  for (int i = 0; i < kernel.num_cases; i++) {
+    for (int pass = 0; pass < 2; pass++) {
+      std::memset(&scratch[0], backgrounds[pass], SCREEN_SIZE);
+      std::memset(ROW_FLAGS(&scratch[0]), 0, SCREEN_HEIGHT);
+      kernel.run(&scratch[0], kernel.param, i);
+
+      for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        if (!ROW_FLAGS(&scratch[0])[y])
+          continue;
+
+        is_row_drawn[y] = 1;
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+          if (scratch[INDEX_OF(x, y)] != backgrounds[pass]) {
+            is_drawn[INDEX_OF(x, y)] = 1;
+          }
+        }
+      }
+    }
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+      if (!is_row_drawn[y])
+        continue;
+
+      for (int x = 0; x < SCREEN_WIDTH; x++) {
+        total += is_drawn[INDEX_OF(x, y)];
+      }
+      std::memset(&is_drawn[INDEX_OF(0, y)], 0, SCREEN_WIDTH);
+      is_row_drawn[y] = 0;
+    }
+  }
+  return static_cast<double>(total) / kernel.num_cases;
+}
+
+static unsigned long long read_cycles() {
+#ifdef HAS_CYCLE_COUNTER
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+struct Timing {
+  double ns;
+  double cycles;
+};
+
+static Timing time_batch(Kernel const &kernel, uint8_t *const buffer,
+                         long const reps) {
+  Clock::time_point const start = Clock::now();
+  unsigned long long const start_cycles = read_cycles();
+
+  for (long rep = 0; rep < reps; rep++) {
+    for (int i = 0; i < kernel.num_cases; i++) {
+      kernel.run(buffer, kernel.param, i);
+    }
+  }
+
+  Timing timing;
+  timing.cycles = static_cast<double>(read_cycles() - start_cycles);
+  timing.ns =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return timing;
+}
+
+static void measure(Kernel const &kernel, double const batch_ns) {
+  double const pixels =
+      kernel.pixels ? static_cast<double>(kernel.pixels) : count_pixels(kernel);
+
+  // blur() writes the whole frame, so give it a frame of its own
+  std::memcpy(g_blur_frame, g_frame, FRAME_BUFFER_SIZE);
+  uint8_t *const buffer =
+      kernel.run == run_blur || kernel.run == run_blur_map ? g_blur_frame
+                                                           : g_frame;
+
+  long reps = 1;
+  Timing timing = time_batch(kernel, buffer, reps); // warms the caches
+  while ((timing = time_batch(kernel, buffer, reps)).ns < batch_ns) {
+    reps *= 2;
+  }
+
+  Timing best = timing;
+  for (int batch = 1; batch < BATCHES; batch++) {
+    timing = time_batch(kernel, buffer, reps);
+    best.ns = std::min(best.ns, timing.ns);
+    best.cycles = std::min(best.cycles, timing.cycles);
+  }
+
+  double const calls = static_cast<double>(reps) * kernel.num_cases;
+  double const ns_per_call = best.ns / calls;
+  double const cycles_per_call = best.cycles / calls;
+  std::printf("%s,%d,%d,%.0f,%.1f,%.2f,%.4f,%.4f\n", kernel.name,
+              SCREEN_WIDTH, SCREEN_HEIGHT, calls * BATCHES, pixels,
+              ns_per_call, pixels ? ns_per_call / pixels : 0.0,
+              pixels ? cycles_per_call / pixels : 0.0);
+  std::fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+  char const *prefix = "";
+  int threads = 1;
+  double batch_ms = 5;
+
+  // Our own options come out of argv; the backend gets the rest (--size)
+  int kept = 1;
+  for (int i = 1; i < argc; i++) {
+    bool const has_value = i + 1 < argc;
+
+    if (!std::strcmp(argv[i], "--kernel") && has_value) {
+      prefix = argv[++i];
+    } else if (!std::strcmp(argv[i], "--threads") && has_value) {
+      threads = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--batch-ms") && has_value) {
+      batch_ms = std::atof(argv[++i]);
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argv[kept] = NULL;
+
+  if (!init_system(kept, argv)) {
+    std::cerr << "kernel options: [--kernel PREFIX] [--threads N]"
+                 " [--batch-ms N]\n";
+    return 1;
+  }
+
+  start_arena(BENCH_FRAMES * frame_buffer_span() + blur_arena_size() +
+              2 * draw_list_arena_size());
+  g_plasma = alloc_frame_buffer();
+  g_frame = alloc_frame_buffer();
+  g_blur_frame = alloc_frame_buffer();
+  init_blur();
+  load_assets(DEFAULT_PACK_PATH, false);
+  start_workers(threads);
+  init_draw_list(g_overlay);
+  bin_draw_list(g_overlay);
+  init_draw_list(g_list);
+
+  // The same cases and plasma every run, whatever the order of the kernels
+  init_rnd(g_effect_rnd, DEFAULT_SEED, kRndEffect);
+  make_cases();
+  make_plasma();
+  for (int kind = 0; kind < kNumFeedbackKinds; kind++) {
+    init_feedback_map(g_maps[kind]);
+    build_feedback_map(g_maps[kind], kind, BENCH_MAP_X, BENCH_MAP_Y);
+  }
+  build_palette(palettes[0], g_rgb);
+
+  std::printf("kernel,width,height,calls,pixels,ns_per_call,ns_per_pixel,"
+              "cycles_per_pixel\n");
+  std::vector<Kernel> const kernels = make_kernels();
+  for (std::size_t i = 0; i < kernels.size(); i++) {
+    if (!std::strncmp(kernels[i].name, prefix, std::strlen(prefix))) {
+      measure(kernels[i], batch_ms * 1e6);
+    }
+  }
+
+  for (int kind = 0; kind < kNumFeedbackKinds; kind++) {
+    free_feedback_map(g_maps[kind]);
+  }
+  stop_workers();
+  stop_arena();
+  return 0;
+}
@@ -0,0 +1,371 @@
+#include "blur.hpp"
+
+#include <algorith> // <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "arena.hpp"
+#include "rnd.hpp"
+#include "workers.hpp"
+
+#ifdef PP_HOST
+#include <vector>
+
+// The SIMD rows are x86 only; other hosts blur with the scalar reference
+#if defined(__x86_64__) || defined(__i386__)
+#include "blur_simd.hpp"
+#define HAS_SIMD_ROWS
+#endif
+#endif
+
+PixelOffset const *target_x = vga_target_x;
+PixelOffset const *target_y = vga_target_y;
+
+static bool has_vga_targets() {
+  return SCREEN_WIDTH == VGA_WIDTH && SCREEN_HEIGHT == VGA_HEIGHT;
+}
+
+static void init_targets() {
+  if (has_vga_targets())
+    return;
+
+  PixelOffset *const new_x = static_cast<PixelOffset *>(
+      arena_alloc(static_cast<long>(sizeof(PixelOffset)) * SCREEN_WIDTH));
+  PixelOffset *const new_y = static_cast<PixelOffset *>(
+      arena_alloc(static_cast<long>(sizeof(PixelOffset)) * SCREEN_HEIGHT));
+
+  for (int i = 0; i < SCREEN_WIDTH; i++) {
+    new_x[i] = target_x_entry(i, SCREEN_WIDTH);
+  }
+  for (int i = 0; i < SCREEN_HEIGHT; i++) {
+    new_y[i] = target_y_entry(i, SCREEN_WIDTH, SCREEN_HEIGHT);
+  }
+
+  target_x = new_x;
+  target_y = new_y;
+}
+
+bool blur_row_reference(uint8_t *const dest, uint8_t const *const src_row) {
+  uint8_t bits = 0;
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    int weighted_sum = 0;
+    uint8_t const *const src = src_row + target_x[x];
+
+    // Center pixel gets 8x weight
+    weighted_sum += src[0] << 2;
+
+    // Top, bottom, left, right get 1x weight
+    weighted_sum += src[1] << 1;
+    weighted_sum += src[SCREEN_WIDTH] << 1;
+
+    weighted_sum += src[-1] << 1;
+    weighted_sum += src[-SCREEN_WIDTH] << 1;
+
+    dest[x] = weighted_averages[weighted_sum];
+    bits |= dest[x];
+  }
+  return bits != 0;
+}
+
+#ifdef HAS_SIMD_ROWS
+static BlurRowFunc blur_row = blur_row_reference;
+static bool has_simd_rows = false; // and so filter_simd() and gather_simd()
+#endif
+
+// Signed offsets added to the noisy palettes' blur. Each band picks a plane and
+// a horizontal shift from the frame seed, so the pattern moves every frame.
+// NUM_DITHER_PLANES planes of BLUR_BAND_ROWS rows of DITHER_WIDTH offsets
+static std::int8_t *dither_planes;
+
+#define DITHER_BATCH 64 // random numbers made at a time
+#define DITHER_SIZE (NUM_DITHER_PLANES * BLUR_BAND_ROWS * DITHER_WIDTH)
+
+static void fill_dither_planes() {
+  int const size = DITHER_SIZE;
+  dither_planes = static_cast<std::int8_t *>(arena_alloc(size));
+
+  // The same planes whatever the game's seed
+  Rnd noise;
+  noise.key = DITHER_SEED;
+  noise.position = 0;
+
+  std::uint32_t numbers[DITHER_BATCH];
+  for (int i = 0; i < size; i++) {
+    if (i % DITHER_BATCH == 0) {
+      fill_rnd(noise, numbers, DITHER_BATCH);
+    }
+    // -1 or 0, like the old get_rnd() % 2 - 1
+    int const bit = static_cast<int>((numbers[i % DITHER_BATCH] >> 16) & 1);
+    // Must stay <= 0 for blur() to skip clear rows
+    dither_planes[i] = static_cast<std::int8_t>(bit - 1);
+  }
+}
+
+void add_dither_reference(uint8_t *const row, std::int8_t const *const dither) {
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    row[x] = static_cast<uint8_t>(clamp(row[x] + dither[x], 0, MAX_COLOR));
+  }
+}
+
+static void add_dither(uint8_t *const row, std::int8_t const *const dither) {
+#ifdef HAS_SIMD_ROWS
+  add_dither_simd(row, dither);
+#else
+  add_dither_reference(row, dither);
+#endif
+}
+
+struct BlurJob {
+  uint8_t *front_buffer;
+  uint8_t const *back_buffer;
+  std::uint32_t seed;
+  DrawList const *overlay; // binned, drawn over each band once it's blurred
+  FeedbackMap const *map;  // NULL for the separable zoom
+};
+
+// Where a band of a noisy frame starts in the dither planes
+static std::int8_t const *band_dither(std::uint32_t const seed,
+                                      int const band) {
+  // Each band's own number, whichever thread blurs it
+  std::uint32_t const pick = rnd_at(seed, band);
+  return dither_planes +
+         (pick % NUM_DITHER_PLANES) * BLUR_BAND_ROWS * DITHER_WIDTH +
+         (pick >> 8) % DITHER_SHIFTS;
+}
+
+template <bool IsNoisy> void blur_band(void *const context, int const band) {
+  BlurJob const &job = *static_cast<BlurJob const *>(context);
+
+  int const first_y = band * BLUR_BAND_ROWS;
+  int const last_y = std::min(first_y + BLUR_BAND_ROWS, SCREEN_HEIGHT);
+
+  std::int8_t const *const dither =
+      IsNoisy ? band_dither(job.seed, band) : NULL;
+
+  uint8_t const *const src_flags = ROW_FLAGS(job.back_buffer);
+  uint8_t *const dest_flags = ROW_FLAGS(job.front_buffer);
+
+  for (int y = first_y; y < last_y; y++) {
+    uint8_t *const row = job.front_buffer + INDEX_OF(0, y);
+    uint8_t const *const src_row = job.back_buffer + target_y[y];
+
+    // A clear neighbourhood blurs to a clear row, and dither only darkens
+    int const src_y = target_y[y] / SCREEN_WIDTH;
+    if (!(src_flags[src_y - 1] | src_flags[src_y] | src_flags[src_y + 1])) {
+      if (dest_flags[y]) {
+        std::memset(row, 0, SCREEN_WIDTH);
+        dest_flags[y] = 0;
+      }
+      continue;
+    }
+
+    // Dither may clear a row, which only makes the flag conservative
+#ifdef HAS_SIMD_ROWS
+    dest_flags[y] = blur_row(row, src_row);
+#else
+    dest_flags[y] = blur_row_reference(row, src_row);
+#endif
+    if (IsNoisy)
+      add_dither(row, dither + (y - first_y) * DITHER_WIDTH);
+  }
+
+  draw_band(*job.overlay, job.front_buffer, band);
+}
+
+#ifdef PP_HOST
+#ifdef HAS_SIMD_ROWS
+// Source pixels a tile through a 2D map may filter before gathering from
+// them. A tile whose sources are spread further blurs a pixel at a time.
+#define MAX_FILTERED_PIXELS (4 * FEEDBACK_TILE_WIDTH * BLUR_BAND_ROWS)
+
+// A tile's filtered sources, and 3 bytes more for gather_simd()
+static thread_local std::vector<uint8_t> t_filtered(MAX_FILTERED_PIXELS + 3);
+#endif
+
+// As blur_row_reference(), for count pixels from (x, y) through a 2D map
+static uint8_t blur_span(uint8_t *const dest, uint8_t const *const back_buffer,
+                         Displacement const *const offsets, int const x,
+                         int const y, int const count) {
+  // Locals, so the stores to dest don't make the compiler reload them
+  long const width = SCREEN_WIDTH;
+  uint8_t const *const origin = back_buffer + INDEX_OF(x, y);
+
+  uint8_t bits = 0;
+  for (int i = 0; i < count; i++) {
+    uint8_t const *const src =
+        origin + i + offsets[i].dx + offsets[i].dy * width;
+
+    int weighted_sum = src[0] << 2;
+    weighted_sum += src[1] << 1;
+    weighted_sum += src[width] << 1;
+    weighted_sum += src[-1] << 1;
+    weighted_sum += src[-width] << 1;
+
+    dest[i] = weighted_averages[weighted_sum];
+    bits |= dest[i];
+  }
+  return bits;
+}
+
+template <bool IsNoisy>
+void blur_band_mapped(void *const context, int const band) {
+  BlurJob const &job = *static_cast<BlurJob const *>(context);
+  FeedbackMap const &map = *job.map;
+
+  int const first_y = band * BLUR_BAND_ROWS;
+  int const last_y = std::min(first_y + BLUR_BAND_ROWS, SCREEN_HEIGHT);
+
+  uint8_t const *const src_flags = ROW_FLAGS(job.back_buffer);
+  uint8_t *const dest_flags = ROW_FLAGS(job.front_buffer);
+
+  // Rows whose sources are all clear blur to clear rows, as in blur_band()
+  bool is_clear[BLUR_BAND_ROWS];
+  uint8_t bits[BLUR_BAND_ROWS];
+  for (int y = first_y; y < last_y; y++) {
+    uint8_t any = 0;
+    for (int src_y = map.first_rows[y] - 1; src_y <= map.last_rows[y] + 1;
+         src_y++) {
+      any |= src_flags[src_y];
+    }
+    is_clear[y - first_y] = !any;
+    bits[y - first_y] = 0;
+    if (!any && dest_flags[y]) {
+      std::memset(job.front_buffer + INDEX_OF(0, y), 0, SCREEN_WIDTH);
+      dest_flags[y] = 0;
+    }
+  }
+
+  int const num_tiles =
+      (SCREEN_WIDTH + FEEDBACK_TILE_WIDTH - 1) / FEEDBACK_TILE_WIDTH;
+#ifdef HAS_SIMD_ROWS
+  uint8_t *const filtered = &t_filtered[0];
+#endif
+  unsigned short const *const tiles = map.tile_order + band * num_tiles;
+  for (int i = 0; i < num_tiles; i++) {
+    int const tile = tiles[i];
+    int const x = tile * FEEDBACK_TILE_WIDTH;
+    int const count = std::min(FEEDBACK_TILE_WIDTH, SCREEN_WIDTH - x);
+
+    // Every pixel is the filtered value of its source, so with SIMD rows the
+    // tile's sources are filtered a row at a time, as the separable rows are,
+    // and each pixel is then only a gather
+    TileSources sources;
+    sources.first_x = static_cast<short>(MAX_X);
+    sources.last_x = 0;
+    sources.first_y = static_cast<short>(MAX_Y);
+    sources.last_y = 0;
+    for (int y = first_y; y < last_y; y++) {
+      if (is_clear[y - first_y])
+        continue;
+
+      TileSources const &row = map.tile_sources[y * num_tiles + tile];
+      sources.first_x = std::min(sources.first_x, row.first_x);
+      sources.last_x = std::max(sources.last_x, row.last_x);
+      sources.first_y = std::min(sources.first_y, row.first_y);
+      sources.last_y = std::max(sources.last_y, row.last_y);
+    }
+    int const height = sources.last_y - sources.first_y + 1;
+    if (height <= 0)
+      continue; // every row is clear
+
+#ifdef HAS_SIMD_ROWS
+    int const width = (sources.last_x - sources.first_x + 16) / 16 * 16;
+    bool const is_filtered =
+        has_simd_rows && width * height <= MAX_FILTERED_PIXELS;
+    if (is_filtered) {
+      for (int src_y = 0; src_y < height; src_y++) {
+        filter_simd(filtered + src_y * width,
+                    job.back_buffer +
+                        INDEX_OF(sources.first_x, sources.first_y + src_y),
+                    width);
+      }
+    }
+#endif
+
+    for (int y = first_y; y < last_y; y++) {
+      if (is_clear[y - first_y])
+        continue;
+
+      uint8_t *const dest = job.front_buffer + INDEX_OF(x, y);
+      Displacement const *const offsets = map.offsets + INDEX_OF(x, y);
+#ifdef HAS_SIMD_ROWS
+      if (is_filtered) {
+        // Where (x, y) would be in the filtered rows
+        long const origin = static_cast<long>(y - sources.first_y) * width +
+                            (x - sources.first_x);
+        bits[y - first_y] |=
+            gather_simd(dest, filtered, origin, offsets, count, width);
+        continue;
+      }
+#endif
+      bits[y - first_y] |=
+          blur_span(dest, job.back_buffer, offsets, x, y, count);
+    }
+  }
+
+  std::int8_t const *const dither =
+      IsNoisy ? band_dither(job.seed, band) : NULL;
+  for (int y = first_y; y < last_y; y++) {
+    if (is_clear[y - first_y])
+      continue;
+
+    dest_flags[y] = bits[y - first_y] != 0;
+    if (IsNoisy)
+      add_dither(job.front_buffer + INDEX_OF(0, y),
+                 dither + (y - first_y) * DITHER_WIDTH);
+  }
+
+  draw_band(*job.overlay, job.front_buffer, band);
+}
+#endif
+
+template <bool IsNoisy>
+void blur(uint8_t *const front_buffer, uint8_t *const back_buffer,
+          std::uint32_t const seed, DrawList const &overlay,
+          FeedbackMap const *const map) {
+  BlurJob job;
+  job.front_buffer = front_buffer;
+  job.back_buffer = back_buffer;
+  job.seed = seed;
+  job.overlay = &overlay;
+  job.map = map;
+
+#ifdef PP_HOST
+  if (map) {
+    run_tasks(blur_band_mapped<IsNoisy>, &job, NUM_BLUR_BANDS);
+    return;
+  }
+#endif
+  run_tasks(blur_band<IsNoisy>, &job, NUM_BLUR_BANDS);
+}
+
+long blur_arena_size() {
+  long size = arena_span(DITHER_SIZE);
+  if (!has_vga_targets()) {
+    size += arena_span(static_cast<long>(sizeof(PixelOffset)) * SCREEN_WIDTH);
+    size += arena_span(static_cast<long>(sizeof(PixelOffset)) * SCREEN_HEIGHT);
+  }
+  return size;
+}
+
+void init_blur() {
+  init_targets();
+  fill_dither_planes();
+
+#ifdef HAS_SIMD_ROWS
+  if (BlurRowFunc const simd_row =
+          init_blur_simd(target_x, weighted_averages, NUM_WEIGHTED_SUMS)) {
+    blur_row = simd_row;
+    has_simd_rows = true;
+  }
+#endif
+}
+
+template void blur<true>(uint8_t *const front_buffer,
+                         uint8_t *const back_buffer, std::uint32_t const seed,
+                         DrawList const &overlay,
+                         FeedbackMap const *const map);
+template void blur<false>(uint8_t *const front_buffer,
+                          uint8_t *const back_buffer, std::uint32_t const seed,
+                          DrawList const &overlay,
+                          FeedbackMap const *const map);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "drawlist.hpp"
+#include "feedback.hpp"
+#include "tables.hpp"
+
+/*
+ * Plasma blur
+ *
+ * Each frame is the last one zoomed slightly out from the middle and blurred,
+ * with the front draw list drawn over each band of rows once it's done. The
+ * noisy palettes add a dither that darkens the plasma so it fades.
+ */
+
+#define BLUR_BAND_ROWS DRAW_BAND_ROWS // blur() draws the front list per band
+#define NUM_BLUR_BANDS ((SCREEN_HEIGHT + BLUR_BAND_ROWS - 1) / BLUR_BAND_ROWS)
+
+#define NUM_DITHER_PLANES 8
+#define DITHER_SHIFTS 64 // horizontal offsets each dither plane can start at
+#define DITHER_SEED 0x2545F491UL
+#define DITHER_WIDTH (SCREEN_WIDTH + DITHER_SHIFTS)
+
+// Where each output pixel's source is, as offsets into the back buffer
+extern PixelOffset const *target_x;
+extern PixelOffset const *target_y;
+
+// What init_blur() takes from the frame arena
+long blur_arena_size();
+
+// Builds the zoom tables for the screen size and the dither in the frame
+// arena, and picks the fastest row kernel. Call once the screen size is known.
+void init_blur();
+
+// The scalar row, which the SIMD rows must match bit for bit
+bool blur_row_reference(std::uint8_t *const dest,
+                        std::uint8_t const *const src_row);
+
+// Only reads back_buffer and only writes front_buffer, so the bands can run in
+// parallel. IsNoisy is chosen once per frame from GameData::is_noisy, and seed
+// is the key of a stream whose band-th number picks that band's dither. A NULL
+// map is the separable zoom, blurred a row at a time; other maps are blurred a
+// tile at a time, in each band's tile order: the tile's sources are filtered
+// with SIMD and then gathered through the map.
+template <bool IsNoisy>
+void blur(std::uint8_t *const front_buffer, std::uint8_t *const back_buffer,
+          std::uint32_t const seed, DrawList const &overlay,
+          FeedbackMap const *const map);
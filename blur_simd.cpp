@@ -0,0 +1,350 @@
+#include "blur_simd.hpp"
+
+// x86 only; blur.cpp keeps to blur_row_reference() on other hosts
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "system.hpp"
+
+using std::uint8_t;
+
+/*
+ * Every output pixel of a row reads the same source row, and target_x is
+ * monotonic with steps of 0 or 1. So each row is done in two passes:
+ *
+ * 1. Filter the source row once per source column with contiguous loads,
+ *    replacing the weighted_averages lookup with (sum * multiplier) >> 16.
+ * 2. Resample the filtered row through target_x. Any 16 consecutive outputs
+ *    come from at most 16 consecutive filtered pixels, so in the AVX2 row a
+ *    precomputed pshufb mask per block does the gather. pshufb is SSSE3, so
+ *    the SSE2 row resamples with the scalar loop; its gain is all in pass 1.
+ */
+
+#define BLOCK 16 // output pixels per resample shuffle
+
+static PixelOffset const *g_target_x;
+static int g_first_src;  // target_x[0]
+static int g_filter_len; // number of source columns actually read
+static unsigned short g_multiplier;
+static bool g_is_avx2; // the row picked, which the 2D-map passes follow
+
+static std::vector<bool> g_block_ok;      // per block of BLOCK outputs
+static std::vector<uint8_t> g_block_mask; // BLOCK shuffle indices per block
+
+static inline unsigned weighted_sum(uint8_t const *const src) {
+  return (src[0] << 2) + ((src[-1] + src[1] + src[-SCREEN_WIDTH] +
+                           src[SCREEN_WIDTH])
+                          << 1);
+}
+
+static inline uint8_t average(unsigned const sum) {
+  return static_cast<uint8_t>((sum * g_multiplier) >> 16);
+}
+
+static uint8_t filter_tail(uint8_t *const filtered, uint8_t const *const src,
+                           int from) {
+  uint8_t bits = 0;
+  for (; from < g_filter_len; ++from) {
+    filtered[from] = average(weighted_sum(src + from));
+    bits |= filtered[from];
+  }
+  return bits;
+}
+
+static void resample_scalar(uint8_t *const dest, uint8_t const *const filtered,
+                            int from) {
+  for (; from < SCREEN_WIDTH; ++from) {
+    dest[from] = filtered[g_target_x[from] - g_first_src];
+  }
+}
+
+// Filters the 16 pixels from p
+static inline __m128i filter_block_sse2(uint8_t const *const p,
+                                        __m128i const multiplier) {
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const c = _mm_loadu_si128((__m128i const *)p);
+  __m128i const l = _mm_loadu_si128((__m128i const *)(p - 1));
+  __m128i const r = _mm_loadu_si128((__m128i const *)(p + 1));
+  __m128i const t = _mm_loadu_si128((__m128i const *)(p - SCREEN_WIDTH));
+  __m128i const b = _mm_loadu_si128((__m128i const *)(p + SCREEN_WIDTH));
+
+  __m128i lo = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpacklo_epi8(l, zero), _mm_unpacklo_epi8(r, zero)),
+      _mm_add_epi16(_mm_unpacklo_epi8(t, zero), _mm_unpacklo_epi8(b, zero)));
+  __m128i hi = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpackhi_epi8(l, zero), _mm_unpackhi_epi8(r, zero)),
+      _mm_add_epi16(_mm_unpackhi_epi8(t, zero), _mm_unpackhi_epi8(b, zero)));
+
+  lo = _mm_add_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(c, zero), 2),
+                     _mm_slli_epi16(lo, 1));
+  hi = _mm_add_epi16(_mm_slli_epi16(_mm_unpackhi_epi8(c, zero), 2),
+                     _mm_slli_epi16(hi, 1));
+
+  lo = _mm_mulhi_epu16(lo, multiplier);
+  hi = _mm_mulhi_epu16(hi, multiplier);
+  return _mm_packus_epi16(lo, hi);
+}
+
+static bool blur_row_sse2(uint8_t *const dest, uint8_t const *const src_row) {
+  uint8_t filtered[MAX_SCREEN_WIDTH + BLOCK];
+  uint8_t const *const src = src_row + g_first_src;
+
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const multiplier = _mm_set1_epi16(static_cast<short>(g_multiplier));
+  __m128i bits = zero;
+
+  int x = 0;
+  for (; x + 16 <= g_filter_len; x += 16) {
+    __m128i const packed = filter_block_sse2(src + x, multiplier);
+    _mm_storeu_si128((__m128i *)(filtered + x), packed);
+    bits = _mm_or_si128(bits, packed);
+  }
+  bool const is_lit = filter_tail(filtered, src, x) ||
+                      _mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero)) != 0xFFFF;
+
+  resample_scalar(dest, filtered, 0);
+  return is_lit;
+}
+
+__attribute__((target("avx2"))) static inline __m128i
+filter_block_avx2(uint8_t const *const p, __m256i const multiplier) {
+  __m256i const c = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)p));
+  __m256i const l =
+      _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)(p - 1)));
+  __m256i const r =
+      _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)(p + 1)));
+  __m256i const t = _mm256_cvtepu8_epi16(
+      _mm_loadu_si128((__m128i const *)(p - SCREEN_WIDTH)));
+  __m256i const b = _mm256_cvtepu8_epi16(
+      _mm_loadu_si128((__m128i const *)(p + SCREEN_WIDTH)));
+
+  __m256i sum = _mm256_add_epi16(_mm256_add_epi16(l, r),
+                                 _mm256_add_epi16(t, b));
+  sum = _mm256_add_epi16(_mm256_slli_epi16(c, 2), _mm256_slli_epi16(sum, 1));
+  sum = _mm256_mulhi_epu16(sum, multiplier);
+
+  // packus works within 128-bit lanes, so pack the two halves together
+  return _mm_packus_epi16(_mm256_castsi256_si128(sum),
+                          _mm256_extracti128_si256(sum, 1));
+}
+
+__attribute__((target("avx2"))) static bool
+blur_row_avx2(uint8_t *const dest, uint8_t const *const src_row) {
+  uint8_t filtered[MAX_SCREEN_WIDTH + BLOCK];
+  uint8_t const *const src = src_row + g_first_src;
+
+  __m256i const multiplier =
+      _mm256_set1_epi16(static_cast<short>(g_multiplier));
+  __m128i bits = _mm_setzero_si128();
+
+  int x = 0;
+  for (; x + 16 <= g_filter_len; x += 16) {
+    __m128i const packed = filter_block_avx2(src + x, multiplier);
+    _mm_storeu_si128((__m128i *)(filtered + x), packed);
+    bits = _mm_or_si128(bits, packed);
+  }
+  // The compiler leaves the upper halves dirty for the rest of the row, and
+  // every SSE instruction after that, down to libm's, pays for it
+  _mm256_zeroupper();
+  bool const is_lit =
+      filter_tail(filtered, src, x) || !_mm_testz_si128(bits, bits);
+
+  for (int block = 0; block < SCREEN_WIDTH / BLOCK; ++block) {
+    int const out_x = block * BLOCK;
+    if (!g_block_ok[block]) {
+      for (int i = out_x; i < out_x + BLOCK; ++i) {
+        dest[i] = filtered[g_target_x[i] - g_first_src];
+      }
+      continue;
+    }
+    __m128i const run = _mm_loadu_si128(
+        (__m128i const *)(filtered + g_target_x[out_x] - g_first_src));
+    __m128i const mask =
+        _mm_loadu_si128((__m128i const *)&g_block_mask[out_x]);
+    _mm_storeu_si128((__m128i *)(dest + out_x), _mm_shuffle_epi8(run, mask));
+  }
+  resample_scalar(dest, filtered, SCREEN_WIDTH / BLOCK * BLOCK);
+  return is_lit;
+}
+
+static void filter_sse2(uint8_t *const dest, uint8_t const *const src,
+                        long const count) {
+  __m128i const multiplier = _mm_set1_epi16(static_cast<short>(g_multiplier));
+  long i = 0;
+  for (; i + 16 <= count; i += 16) {
+    _mm_storeu_si128((__m128i *)(dest + i),
+                     filter_block_sse2(src + i, multiplier));
+  }
+  for (; i < count; ++i) {
+    dest[i] = average(weighted_sum(src + i));
+  }
+}
+
+__attribute__((target("avx2"))) static void
+filter_avx2(uint8_t *const dest, uint8_t const *const src, long const count) {
+  __m256i const multiplier =
+      _mm256_set1_epi16(static_cast<short>(g_multiplier));
+  long i = 0;
+  for (; i + 16 <= count; i += 16) {
+    _mm_storeu_si128((__m128i *)(dest + i),
+                     filter_block_avx2(src + i, multiplier));
+  }
+  _mm256_zeroupper();
+  for (; i < count; ++i) {
+    dest[i] = average(weighted_sum(src + i));
+  }
+}
+
+static uint8_t gather_scalar(uint8_t *const dest, uint8_t const *const src,
+                             long const origin,
+                             Displacement const *const offsets,
+                             int const count, int const stride) {
+  uint8_t bits = 0;
+  for (int i = 0; i < count; ++i) {
+    dest[i] = src[origin + i + offsets[i].dx +
+                  static_cast<long>(offsets[i].dy) * stride];
+    bits |= dest[i];
+  }
+  return bits;
+}
+
+__attribute__((target("avx2"))) static uint8_t
+gather_avx2(uint8_t *const dest, uint8_t const *const src, long const origin,
+            Displacement const *const offsets, int const count,
+            int const stride) {
+  // A displacement is dx in the low half of a dword and dy in the high, so
+  // one multiply-add makes dx + dy * stride
+  __m256i const strides = _mm256_set1_epi32((stride << 16) | 1);
+  __m256i const byte = _mm256_set1_epi32(0xFF);
+  __m256i index = _mm256_add_epi32(_mm256_set1_epi32(origin),
+                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  __m128i bits = _mm_setzero_si128();
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i const d = _mm256_loadu_si256((__m256i const *)(offsets + i));
+    __m256i const at = _mm256_add_epi32(_mm256_madd_epi16(d, strides), index);
+    __m256i const pixels = _mm256_and_si256(
+        _mm256_i32gather_epi32((int const *)src, at, 1), byte);
+
+    __m128i const words = _mm_packus_epi32(_mm256_castsi256_si128(pixels),
+                                           _mm256_extracti128_si256(pixels, 1));
+    __m128i const packed = _mm_packus_epi16(words, words);
+    _mm_storel_epi64((__m128i *)(dest + i), packed);
+    bits = _mm_or_si128(bits, packed);
+    index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+  }
+  _mm256_zeroupper();
+
+  uint8_t const tail = gather_scalar(dest + i, src, origin + i, offsets + i,
+                                     count - i, stride);
+  return tail | (_mm_testz_si128(bits, bits) ? 0 : 1);
+}
+
+void filter_simd(uint8_t *const dest, uint8_t const *const src,
+                 long const count) {
+  if (g_is_avx2) {
+    filter_avx2(dest, src, count);
+  } else {
+    filter_sse2(dest, src, count);
+  }
+}
+
+uint8_t gather_simd(uint8_t *const dest, uint8_t const *const src,
+                    long const origin, Displacement const *const offsets,
+                    int const count, int const stride) {
+  if (g_is_avx2)
+    return gather_avx2(dest, src, origin, offsets, count, stride);
+  return gather_scalar(dest, src, origin, offsets, count, stride);
+}
+
+void add_dither_simd(uint8_t *const row, std::int8_t const *const dither) {
+  __m128i const zero = _mm_setzero_si128();
+
+  int x = 0;
+  for (; x + 16 <= SCREEN_WIDTH; x += 16) {
+    __m128i const d = _mm_loadu_si128((__m128i const *)(dither + x));
+    __m128i const negative = _mm_cmplt_epi8(d, zero);
+    __m128i const raise = _mm_andnot_si128(negative, d);
+    __m128i const lower = _mm_and_si128(negative, _mm_sub_epi8(zero, d));
+
+    __m128i pixels = _mm_loadu_si128((__m128i const *)(row + x));
+    pixels = _mm_subs_epu8(_mm_adds_epu8(pixels, raise), lower);
+    _mm_storeu_si128((__m128i *)(row + x), pixels);
+  }
+  for (; x < SCREEN_WIDTH; ++x) {
+    int const color = row[x] + dither[x];
+    row[x] = static_cast<uint8_t>(color < 0 ? 0 : color > 255 ? 255 : color);
+  }
+}
+
+// Finds m such that (i * m) >> 16 reproduces the table, if there is one.
+static bool find_multiplier(uint8_t const *const weighted_averages,
+                            int const num_weights) {
+  int const top = num_weights - 1;
+  long const lowest =
+      (static_cast<long>(weighted_averages[top]) << 16) / (top ? top : 1);
+
+  for (long m = lowest; m <= lowest + 256 && m <= 0xFFFF; ++m) {
+    bool matches = true;
+    for (int i = 0; i < num_weights && matches; ++i) {
+      matches = ((i * m) >> 16) == weighted_averages[i];
+    }
+    if (matches) {
+      g_multiplier = static_cast<unsigned short>(m);
+      return true;
+    }
+  }
+  return false;
+}
+
+BlurRowFunc init_blur_simd(PixelOffset const *const target_x,
+                           uint8_t const *const weighted_averages,
+                           int const num_weights) {
+  char const *const forced = std::getenv("PP_BLUR");
+  if (forced && !std::strcmp(forced, "scalar"))
+    return NULL;
+
+  if (num_weights > 0x10000 || !find_multiplier(weighted_averages, num_weights))
+    return NULL;
+
+  g_target_x = target_x;
+  g_first_src = target_x[0];
+  g_filter_len = target_x[SCREEN_WIDTH - 1] - g_first_src + 1;
+
+  for (int x = 1; x < SCREEN_WIDTH; ++x) {
+    int const step = target_x[x] - target_x[x - 1];
+    if (step < 0 || step > 1)
+      return NULL; // not the shape these kernels assume
+  }
+
+  int const num_blocks = SCREEN_WIDTH / BLOCK;
+  g_block_ok.assign(num_blocks, true);
+  g_block_mask.assign(num_blocks * BLOCK, 0);
+  for (int block = 0; block < num_blocks; ++block) {
+    int const out_x = block * BLOCK;
+    for (int i = 0; i < BLOCK; ++i) {
+      int const offset = target_x[out_x + i] - target_x[out_x];
+      g_block_ok[block] = g_block_ok[block] && offset < BLOCK;
+      g_block_mask[out_x + i] = static_cast<uint8_t>(offset & (BLOCK - 1));
+    }
+  }
+
+  __builtin_cpu_init();
+  g_is_avx2 = false;
+  bool const want_sse2 = forced && !std::strcmp(forced, "sse2");
+  if (!want_sse2 && __builtin_cpu_supports("avx2")) {
+    g_is_avx2 = true;
+    return blur_row_avx2;
+  }
+  if (__builtin_cpu_supports("sse2"))
+    return blur_row_sse2;
+  return NULL;
+}
+
+#endif
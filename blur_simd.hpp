@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+#include "feedback.hpp"
+#include "tables.hpp"
+
+// Vectorized rows for blur(). x86 host builds only; the scalar loop in blur.cpp
+// is the reference these must match bit for bit.
+
+// Blurs one output row. src_row points at the start of the source row in the
+// back buffer (back_buffer + target_y[y]). Returns false only if the row came
+// out all zero.
+typedef bool (*BlurRowFunc)(std::uint8_t *const dest,
+                            std::uint8_t const *const src_row);
+
+// Picks the widest kernel the CPU supports (or the one named by the PP_BLUR
+// environment variable: scalar, sse2 or avx2). Returns NULL when blur() should
+// use the scalar reference, e.g. when weighted_averages can't be expressed as a
+// multiply-shift.
+BlurRowFunc init_blur_simd(PixelOffset const *const target_x,
+                           std::uint8_t const *const weighted_averages,
+                           int const num_weights);
+
+// The two passes of a blur through a 2D feedback map, once init_blur_simd()
+// has returned a row. filter_simd() writes the weighted average of each of
+// count pixels from src and its four neighbours, as blur_row_reference() would
+// before resampling. gather_simd() sets dest[i] to src[origin + i + dx + dy *
+// stride] from offsets[i], reading up to 3 bytes past the one it wants, and
+// returns nonzero if any of them is.
+void filter_simd(std::uint8_t *const dest, std::uint8_t const *const src,
+                 long const count);
+std::uint8_t gather_simd(std::uint8_t *const dest,
+                         std::uint8_t const *const src, long const origin,
+                         Displacement const *const offsets, int const count,
+                         int const stride);
+
+// Adds a row of signed dither to a blurred row with saturation.
+void add_dither_simd(std::uint8_t *const row, std::int8_t const *const dither);
@@ -0,0 +1,62 @@
+#include "bot.hpp"
+
+#include "drawing.hpp"
+#include "fixed.hpp"
+
+static int pick_aim(Bot &bot) {
+  return get_rnd(bot.rnd) % (2 * BOT_AIM_RANGE + 1) - BOT_AIM_RANGE;
+}
+
+// Moves position towards target by at most speed, within the mouse's range
+static int step_towards(int const position, int const target, int const speed,
+                        int const size) {
+  int step = target - position;
+  if (step > speed) {
+    step = speed;
+  } else if (step < -speed) {
+    step = -speed;
+  }
+
+  int const next = position + step;
+  if (next < MOUSE_MARGIN)
+    return MOUSE_MARGIN;
+  if (next > size - MOUSE_MARGIN - 1)
+    return size - MOUSE_MARGIN - 1;
+  return next;
+}
+
+void init_bot(Bot &bot, std::uint32_t const seed) {
+  init_rnd(bot.rnd, seed, kRndBot);
+  bot.speed = BOT_MIN_SPEED + get_rnd(bot.rnd) % (BOT_SPEED_RANGE + 1);
+  bot.aim_x = pick_aim(bot);
+  bot.aim_y = pick_aim(bot);
+  bot.is_ball_down = true;
+  bot.is_ball_right = true;
+  bot.mouse.x = MID_X;
+  bot.mouse.y = MID_Y;
+  bot.mouse.buttons = 0;
+}
+
+void get_bot_input(Bot &bot, GameData const &g, MouseState &mouse) {
+  bool const is_ball_down = g.ball_dy > 0;
+  bool const is_ball_right = g.ball_dx > 0;
+  if (is_ball_down != bot.is_ball_down) {
+    bot.is_ball_down = is_ball_down;
+    bot.aim_x = pick_aim(bot);
+  }
+  if (is_ball_right != bot.is_ball_right) {
+    bot.is_ball_right = is_ball_right;
+    bot.aim_y = pick_aim(bot);
+  }
+
+  // mouse.x puts the bottom paddle at x and the top one at MAX_X - x, and
+  // mouse.y the left one at y and the right one at MAX_Y - y
+  int const x = fixed_to_int(g.ball_x) + bot.aim_x;
+  int const y = fixed_to_int(g.ball_y) + bot.aim_y;
+  int const target_x = is_ball_down ? x : MAX_X - x;
+  int const target_y = is_ball_right ? MAX_Y - y : y;
+
+  bot.mouse.x = step_towards(bot.mouse.x, target_x, bot.speed, SCREEN_WIDTH);
+  bot.mouse.y = step_towards(bot.mouse.y, target_y, bot.speed, SCREEN_HEIGHT);
+  mouse = bot.mouse;
+}
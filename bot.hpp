@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "game.hpp"
+#include "rnd.hpp"
+#include "system.hpp"
+
+/*
+ * Autoplay bot
+ *
+ * Plays a game in place of the mouse. Each tick it moves the paddles the ball
+ * is heading for towards it, no faster than its speed, and aims to meet it a
+ * little off the middle of the paddle, at a spot picked afresh whenever the
+ * ball turns. Its speed and aim come from its own stream, so a bot with the
+ * same seed plays the same game every time, and bots with different seeds are
+ * good at it to different degrees.
+ */
+
+#define BOT_MIN_SPEED (2 * SCREEN_SCALE) // pixels a tick
+#define BOT_SPEED_RANGE (3 * SCREEN_SCALE)
+#define BOT_AIM_RANGE (HALF_PADDLE_HIT - 2 * SCREEN_SCALE) // either way
+
+struct Bot {
+  Rnd rnd; // the kRndBot stream
+  int speed;
+  int aim_x; // from the middle of the paddle
+  int aim_y;
+  bool is_ball_down; // which way the ball was heading when the aims were picked
+  bool is_ball_right;
+  MouseState mouse; // as scaled to the screen
+};
+
+void init_bot(Bot &bot, std::uint32_t const seed);
+
+// Moves the paddles for the next tick of g
+void get_bot_input(Bot &bot, GameData const &g, MouseState &mouse);
@@ -0,0 +1,427 @@
+#include "capture.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using std::uint8_t;
+
+/*
+ * FLC layout (all values little-endian):
+ *
+ *   128-byte file header
+ *   per frame: 16-byte frame chunk header (type 0xF1FA) followed by
+ *     COLOR_256 if the palette changed since the last frame
+ *     BYTE_RUN for the first frame, then DELTA_FLC against the previous one,
+ *     or BYTE_RUN again when that is smaller. Unchanged frames have no
+ *     subchunks.
+ */
+
+#define POOL_FRAMES 8
+
+#define FLC_MAGIC 0xAF12
+#define FLC_FRAME_MAGIC 0xF1FA
+#define FLC_HEADER_SIZE 128
+#define FLC_FRAME_HEADER_SIZE 16
+#define FLC_CHUNK_HEADER_SIZE 6
+
+#define CHUNK_COLOR_256 4
+#define CHUNK_DELTA_FLC 7
+#define CHUNK_BYTE_RUN 15
+
+#define MAX_LITERAL_WORDS 127
+#define MAX_REPEAT_WORDS 128
+#define MAX_COLUMN_SKIP 254 // bytes; even so packets stay word-aligned
+
+#define MAX_FLC_FRAMES 0xFFFF // the header's frame count is 16 bits
+
+#define LINE_SKIP_OPCODE 0xC000
+#define LAST_BYTE_OPCODE 0x8000
+
+static std::FILE *g_file = NULL;
+static int g_width;
+static int g_height;
+static unsigned long g_num_frames;
+static unsigned long g_stalls;
+static unsigned long g_dropped; // past MAX_FLC_FRAMES
+
+static CaptureFrame g_pool[POOL_FRAMES];
+static std::deque<CaptureFrame *> g_free;
+static std::deque<CaptureFrame *> g_queued;
+static bool g_stopping;
+
+static std::mutex g_mutex;
+static std::condition_variable g_frame_freed;
+static std::condition_variable g_frame_queued;
+static std::thread g_writer;
+
+// Chunk bytes are built here and then written in one go
+static std::vector<uint8_t> g_chunk;
+static std::vector<uint8_t> g_body;
+
+static void put_u8(std::vector<uint8_t> &out, unsigned const value) {
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+static void put_u16(std::vector<uint8_t> &out, unsigned const value) {
+  put_u8(out, value & 0xFF);
+  put_u8(out, (value >> 8) & 0xFF);
+}
+
+static void put_u32(std::vector<uint8_t> &out, unsigned long const value) {
+  put_u16(out, value & 0xFFFF);
+  put_u16(out, (value >> 16) & 0xFFFF);
+}
+
+static void patch_u16(std::vector<uint8_t> &out, std::size_t const at,
+                      unsigned const value) {
+  out[at] = static_cast<uint8_t>(value & 0xFF);
+  out[at + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+static void patch_u32(std::vector<uint8_t> &out, std::size_t const at,
+                      unsigned long const value) {
+  patch_u16(out, at, value & 0xFFFF);
+  patch_u16(out, at + 2, (value >> 16) & 0xFFFF);
+}
+
+static void write_header(unsigned long const file_size, int const ms_per_frame,
+                         unsigned long const second_frame) {
+  std::vector<uint8_t> header;
+  put_u32(header, file_size);
+  put_u16(header, FLC_MAGIC);
+  put_u16(header, g_num_frames & 0xFFFF);
+  put_u16(header, g_width);
+  put_u16(header, g_height);
+  put_u16(header, 8); // bits per pixel
+  put_u16(header, 3); // flags: written completely
+  put_u32(header, ms_per_frame);
+  header.resize(80, 0);                            // creator, dates, aspect
+  put_u32(header, FLC_HEADER_SIZE);                // first frame
+  put_u32(header, second_frame);                   // second frame
+  header.resize(FLC_HEADER_SIZE, 0);
+
+  std::fseek(g_file, 0, SEEK_SET);
+  std::fwrite(&header[0], 1, header.size(), g_file);
+}
+
+static void begin_chunk(std::vector<uint8_t> &out, unsigned const type) {
+  put_u32(out, 0); // patched by end_chunk()
+  put_u16(out, type);
+}
+
+static void end_chunk(std::vector<uint8_t> &out, std::size_t const start) {
+  if ((out.size() - start) & 1)
+    put_u8(out, 0); // chunks are padded to an even size
+  patch_u32(out, start, out.size() - start);
+}
+
+static void encode_palette(std::vector<uint8_t> &out,
+                           CaptureFrame const &frame) {
+  std::size_t const start = out.size();
+  begin_chunk(out, CHUNK_COLOR_256);
+  put_u16(out, 1); // one packet
+  put_u8(out, 0);  // skip no entries
+  put_u8(out, 0);  // 0 means all 256
+  for (int i = 0; i < NUM_COLORS; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      // FLC palettes are 8-bit
+      uint8_t const component = frame.palette[i][c];
+      put_u8(out, (component << 2) | (component >> 4));
+    }
+  }
+  end_chunk(out, start);
+}
+
+static void encode_byte_run(std::vector<uint8_t> &out,
+                            uint8_t const *const pixels) {
+  std::size_t const start = out.size();
+  begin_chunk(out, CHUNK_BYTE_RUN);
+
+  for (int y = 0; y < g_height; ++y) {
+    uint8_t const *const line = pixels + static_cast<long>(y) * g_width;
+    put_u8(out, 0); // packet count, unused by readers
+
+    int x = 0;
+    while (x < g_width) {
+      int run = 1;
+      while (x + run < g_width && run < 127 && line[x + run] == line[x]) {
+        ++run;
+      }
+
+      if (run > 2) {
+        put_u8(out, run); // positive: repeat one byte
+        put_u8(out, line[x]);
+        x += run;
+        continue;
+      }
+
+      // Literal bytes up to the next run of three
+      int count = 0;
+      while (x + count < g_width && count < 127 &&
+             !(x + count + 2 < g_width &&
+               line[x + count] == line[x + count + 1] &&
+               line[x + count] == line[x + count + 2])) {
+        ++count;
+      }
+      put_u8(out, static_cast<uint8_t>(-count)); // negative: copy bytes
+      out.insert(out.end(), line + x, line + x + count);
+      x += count;
+    }
+  }
+  end_chunk(out, start);
+}
+
+static unsigned word_at(uint8_t const *const line, int const word) {
+  return line[word * 2] | (line[word * 2 + 1] << 8);
+}
+
+// Packets for one line as DELTA_FLC words. Returns the packet count.
+static unsigned encode_delta_line(std::vector<uint8_t> &out,
+                                  uint8_t const *const prev,
+                                  uint8_t const *const curr) {
+  int const words = g_width / 2;
+  unsigned packets = 0;
+  int skipped = 0; // bytes since the end of the last packet
+
+  int w = 0;
+  while (w < words) {
+    if (word_at(prev, w) == word_at(curr, w)) {
+      ++w;
+      skipped += 2;
+      continue;
+    }
+
+    while (skipped > MAX_COLUMN_SKIP) {
+      // Too far to skip in one packet; copy one unchanged word on the way
+      int const hop = MAX_COLUMN_SKIP;
+      int const word = w - (skipped - hop) / 2;
+      put_u8(out, hop);
+      put_u8(out, 1);
+      put_u16(out, word_at(curr, word));
+      ++packets;
+      skipped -= hop + 2;
+    }
+
+    int repeat = 1;
+    while (w + repeat < words && repeat < MAX_REPEAT_WORDS &&
+           word_at(curr, w + repeat) == word_at(curr, w)) {
+      ++repeat;
+    }
+
+    put_u8(out, skipped);
+    if (repeat > 1) {
+      put_u8(out, static_cast<uint8_t>(-repeat));
+      put_u16(out, word_at(curr, w));
+      w += repeat;
+    } else {
+      int count = 1;
+      while (w + count < words && count < MAX_LITERAL_WORDS &&
+             word_at(prev, w + count) != word_at(curr, w + count) &&
+             word_at(curr, w + count) != word_at(curr, w + count - 1)) {
+        ++count;
+      }
+      put_u8(out, count);
+      out.insert(out.end(), curr + w * 2, curr + (w + count) * 2);
+      w += count;
+    }
+    ++packets;
+    skipped = 0;
+  }
+  return packets;
+}
+
+static void encode_delta(std::vector<uint8_t> &out, uint8_t const *const prev,
+                         uint8_t const *const curr) {
+  std::size_t const start = out.size();
+  begin_chunk(out, CHUNK_DELTA_FLC);
+  std::size_t const line_count_at = out.size();
+  put_u16(out, 0);
+
+  bool const is_odd = g_width & 1;
+  unsigned lines = 0;
+  int skipped_lines = 0;
+
+  for (int y = 0; y < g_height; ++y) {
+    long const offset = static_cast<long>(y) * g_width;
+    uint8_t const *const p = prev + offset;
+    uint8_t const *const c = curr + offset;
+
+    if (!std::memcmp(p, c, g_width)) {
+      ++skipped_lines;
+      continue;
+    }
+
+    if (skipped_lines) {
+      put_u16(out, (LINE_SKIP_OPCODE | (0x10000 - skipped_lines)) & 0xFFFF);
+      skipped_lines = 0;
+    }
+    if (is_odd)
+      put_u16(out, LAST_BYTE_OPCODE | c[g_width - 1]);
+
+    std::size_t const packets_at = out.size();
+    put_u16(out, 0);
+    patch_u16(out, packets_at, encode_delta_line(out, p, c));
+    ++lines;
+  }
+
+  patch_u16(out, line_count_at, lines);
+  end_chunk(out, start);
+}
+
+static void encode_frame(CaptureFrame const &frame,
+                         CaptureFrame const *const prev) {
+  g_chunk.clear();
+  put_u32(g_chunk, 0); // patched below
+  put_u16(g_chunk, FLC_FRAME_MAGIC);
+  put_u16(g_chunk, 0); // subchunk count
+  g_chunk.resize(FLC_FRAME_HEADER_SIZE, 0);
+
+  unsigned chunks = 0;
+
+  if (frame.is_palette_changed || !prev) {
+    encode_palette(g_chunk, frame);
+    ++chunks;
+  }
+
+  uint8_t const *const pixels = &frame.pixels[0];
+  if (!prev) {
+    encode_byte_run(g_chunk, pixels);
+    ++chunks;
+  } else if (std::memcmp(&prev->pixels[0], pixels, frame.pixels.size())) {
+    g_body.clear();
+    encode_delta(g_body, &prev->pixels[0], pixels);
+
+    // Plasma can change nearly every pixel, where a key frame is smaller
+    if (g_body.size() > frame.pixels.size() / 2) {
+      std::vector<uint8_t> key;
+      encode_byte_run(key, pixels);
+      if (key.size() < g_body.size())
+        g_body.swap(key);
+    }
+    g_chunk.insert(g_chunk.end(), g_body.begin(), g_body.end());
+    ++chunks;
+  }
+
+  patch_u32(g_chunk, 0, g_chunk.size());
+  patch_u16(g_chunk, 6, chunks);
+  std::fwrite(&g_chunk[0], 1, g_chunk.size(), g_file);
+  ++g_num_frames;
+}
+
+static void writer_main(int const ms_per_frame) {
+  CaptureFrame *prev = NULL;
+  unsigned long second_frame = 0;
+
+  for (;;) {
+    CaptureFrame *frame;
+    {
+      std::unique_lock<std::mutex> lock(g_mutex);
+      while (g_queued.empty() && !g_stopping) {
+        g_frame_queued.wait(lock);
+      }
+      if (g_queued.empty())
+        break;
+      frame = g_queued.front();
+      g_queued.pop_front();
+    }
+
+    // A full file keeps its last frame and the rest go straight back
+    if (g_num_frames == MAX_FLC_FRAMES) {
+      if (!g_dropped++) {
+        std::cerr << "capture: stopped at " << MAX_FLC_FRAMES
+                  << " frames, the most an FLC holds\n";
+      }
+      std::lock_guard<std::mutex> lock(g_mutex);
+      g_free.push_back(frame);
+      g_frame_freed.notify_one();
+      continue;
+    }
+
+    encode_frame(*frame, prev);
+    if (g_num_frames == 1)
+      second_frame = std::ftell(g_file);
+
+    if (prev) {
+      std::lock_guard<std::mutex> lock(g_mutex);
+      g_free.push_back(prev);
+      g_frame_freed.notify_one();
+    }
+    prev = frame;
+  }
+
+  write_header(std::ftell(g_file), ms_per_frame, second_frame);
+}
+
+bool start_capture(char const *const path, int const width, int const height,
+                   int const ms_per_frame) {
+  if ((g_file = std::fopen(path, "wb")) == NULL) {
+    std::cerr << "Unable to write " << path << "\n";
+    return false;
+  }
+
+  g_width = width;
+  g_height = height;
+  g_num_frames = 0;
+  g_stalls = 0;
+  g_dropped = 0;
+  g_stopping = false;
+
+  for (int i = 0; i < POOL_FRAMES; ++i) {
+    g_pool[i].pixels.assign(static_cast<std::size_t>(width) * height, 0);
+    g_pool[i].is_palette_changed = false;
+    g_free.push_back(&g_pool[i]);
+  }
+
+  // Placeholder until the frame count and size are known
+  std::vector<uint8_t> header(FLC_HEADER_SIZE, 0);
+  std::fwrite(&header[0], 1, header.size(), g_file);
+
+  g_writer = std::thread(writer_main, ms_per_frame);
+  return true;
+}
+
+CaptureFrame &acquire_capture_frame() {
+  std::unique_lock<std::mutex> lock(g_mutex);
+  if (g_free.empty()) {
+    ++g_stalls;
+    while (g_free.empty()) {
+      g_frame_freed.wait(lock);
+    }
+  }
+  CaptureFrame *const frame = g_free.front();
+  g_free.pop_front();
+  return *frame;
+}
+
+void submit_capture_frame(CaptureFrame &frame) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_queued.push_back(&frame);
+  g_frame_queued.notify_one();
+}
+
+void stop_capture() {
+  if (!g_file)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_stopping = true;
+  }
+  g_frame_queued.notify_one();
+  g_writer.join();
+
+  std::fclose(g_file);
+  g_file = NULL;
+
+  std::printf("capture: %lu frames, game waited on the writer %lu times",
+              g_num_frames, g_stalls);
+  if (g_dropped) {
+    std::printf(", %lu frames past the FLC limit dropped", g_dropped);
+  }
+  std::printf("\n");
+}
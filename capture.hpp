@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "system.hpp"
+
+/*
+ * Video capture for the headless backend.
+ *
+ * Presented frames are encoded to an Autodesk FLC animation on a background
+ * thread. Frames come from a small recycled pool: the backend presents straight
+ * into a pool frame instead of its own video memory, so handing a frame to the
+ * writer costs a pointer, not a copy.
+ */
+
+struct CaptureFrame {
+  std::vector<std::uint8_t> pixels;
+  std::uint8_t palette[NUM_COLORS][3]; // 6-bit DAC components
+  bool is_palette_changed;
+};
+
+bool start_capture(char const *const path, int const width, int const height,
+                   int const ms_per_frame);
+
+// Returns a free frame to present into. Only waits if the writer has fallen a
+// whole pool behind.
+CaptureFrame &acquire_capture_frame();
+
+// Queues a frame for encoding. Its pixels stay valid until the next frame is
+// submitted.
+void submit_capture_frame(CaptureFrame &frame);
+
+// Finishes the file and prints how often the game had to wait for the writer.
+// A file holds at most 65535 frames, and any after that are dropped.
+void stop_capture();
@@ -2,10 +2,13 @@
 
 #include <cassert>
 #include <cstring>
+#include <iostream>
 
 #include <conio.h>
 #include <dos.h>
 
+#include "present.hpp"
+
 using std::uint8_t;
 
 // System
@@ -23,12 +26,29 @@ using std::uint8_t;
 #define INPUT_STATUS 0x03da
 #define VRETRACE 0x08
 
+#define PIT_CHANNEL0 0x40 // 8253 timer, which runs the BIOS clock
+#define PIT_COMMAND 0x43
+#define PIT_LATCH0 0x00
+#define PIT_RATE_GENERATOR0 0x34 // channel 0, low then high byte, mode 2
+#define PIT_SQUARE_WAVE0 0x36    // the same in mode 3, as the BIOS sets it
+#define PIT_TICK_US 54925UL      // 65536 timer counts, one BIOS tick
+#define PIT_COUNT_NS 838UL       // one timer count
+#define BIOS_TICKS_PER_DAY 0x1800B0UL
+
+#define MULTIPLEX_INT 0x2F
+#define RELEASE_TIME_SLICE 0x1680
+
+#define RETRACE_US (1000000UL / REFRESH_RATE)
+#define RETRACE_MARGIN_US 2000 // stop sleeping this long before a retrace
+
 #define PALETTE_MASK 0x03c6
 #define PALETTE_REGISTER_READ 0x03c7
 #define PALETTE_REGISTER_WRITE 0x03c8
 #define PALETTE_DATA 0x03c9
 
 static uint8_t *const VGA = (uint8_t *)0xA0000000L; // location of video memory
+static std::uint32_t volatile const *const BIOS_TICKS =
+    (std::uint32_t volatile const *)0x0040006CL; // 18.2 Hz since midnight
 
 inline uint8_t get_mode() {
   REGS regs;
@@ -45,8 +65,35 @@ inline void set_mode(uint8_t const mode) {
 }
 
 static uint8_t g_orig_mode = 0xFF;
+static uint8_t *g_shadow = NULL; // what VGA holds, much faster to read
+static bool g_is_shadow_valid = false;
+static std::uint32_t g_last_time = 0;
+static std::uint32_t g_last_ticks = 0;
+static std::uint32_t g_midnight_ticks = 0; // the BIOS count restarts daily
+static std::uint32_t g_last_retrace = 0;
+
+static void set_pit_mode(uint8_t const command) {
+  // A count of 0 is 65536, the BIOS's own rate
+  _disable();
+  outp(PIT_COMMAND, command);
+  outp(PIT_CHANNEL0, 0);
+  outp(PIT_CHANNEL0, 0);
+  _enable();
+}
+
+bool init_system(int, char *[]) {
+  // Mode 2 counts down once per period instead of twice, so the count can be
+  // read as the time since the last BIOS tick
+  set_pit_mode(PIT_RATE_GENERATOR0);
+  return true;
+}
 
 bool set_vga_mode() {
+  if (!g_shadow && (g_shadow = new uint8_t[SCREEN_SIZE]) == NULL) {
+    std::cerr << "Not enough memory for shadow buffer.\n";
+    return false;
+  }
+
   uint8_t cur_mode = get_mode();
   if (cur_mode == VGA_256_COLOR_MODE)
     return true;
@@ -61,15 +108,70 @@ void reset_mode() {
   if (g_orig_mode != 0xFF) {
     set_mode(g_orig_mode);
   }
+  set_pit_mode(PIT_SQUARE_WAVE0);
+
+  delete[] g_shadow;
+  g_shadow = NULL;
+  g_is_shadow_valid = false;
+}
+
+std::uint32_t get_time_us() {
+  _disable();
+  outp(PIT_COMMAND, PIT_LATCH0);
+  unsigned const low = inp(PIT_CHANNEL0);
+  unsigned const high = inp(PIT_CHANNEL0);
+  std::uint32_t ticks = *BIOS_TICKS + g_midnight_ticks;
+  _enable();
+
+  if (ticks < g_last_ticks) {
+    g_midnight_ticks += BIOS_TICKS_PER_DAY;
+    ticks += BIOS_TICKS_PER_DAY;
+  }
+  g_last_ticks = ticks;
+
+  unsigned const counts = (0x10000UL - ((high << 8) | low)) & 0xFFFF;
+  std::uint32_t const now =
+      ticks * PIT_TICK_US + counts * PIT_COUNT_NS / 1000;
+
+  // If the count wrapped while the tick interrupt was held off, the tick
+  // hasn't been added yet and the time seems to go back. Hold it until then.
+  if (static_cast<std::int32_t>(now - g_last_time) > 0) {
+    g_last_time = now;
+  }
+  return g_last_time;
 }
 
-void show_buffer(uint8_t *const front_buffer) {
+void wait_until(std::uint32_t const time_us) {
+  while (static_cast<std::int32_t>(time_us - get_time_us()) > 0) {
+    // Lets Windows or another DPMI host run something else; plain DOS
+    // ignores it
+    REGS regs;
+    regs.x.ax = RELEASE_TIME_SLICE;
+    int86(MULTIPLEX_INT, &regs, &regs);
+  }
+}
+
+long show_buffer(uint8_t *const front_buffer, uint8_t const *const palette) {
+  // Sleep through most of the frame and only poll near the retrace
+  wait_until(g_last_retrace + RETRACE_US - RETRACE_MARGIN_US);
+
   while ((inp(INPUT_STATUS) & VRETRACE))
     ;
   while (!(inp(INPUT_STATUS) & VRETRACE))
     ;
+  g_last_retrace = get_time_us();
+
+  if (palette) {
+    set_palette_block(0, NUM_COLORS, palette);
+  }
 
-  std::memcpy(VGA, front_buffer, SCREEN_SIZE);
+  if (!g_is_shadow_valid) {
+    std::memcpy(VGA, front_buffer, SCREEN_SIZE);
+    std::memcpy(g_shadow, front_buffer, SCREEN_SIZE);
+    g_is_shadow_valid = true;
+    return SCREEN_SIZE;
+  }
+  return present_changes(VGA, g_shadow, front_buffer, SCREEN_SIZE);
 }
 
 void set_pal_entry(uint8_t const index, uint8_t const red, uint8_t const green,
@@ -84,6 +186,17 @@ void set_pal_entry(uint8_t const index, uint8_t const red, uint8_t const green,
   outp(PALETTE_DATA, blue);            // blue
 }
 
+void set_palette_block(uint8_t const first, int const count,
+                       uint8_t const *const rgb) {
+  outp(PALETTE_MASK, 0xff);
+  outp(PALETTE_REGISTER_WRITE, first); // the DAC advances after each blue
+
+  for (int i = 0; i < count * 3; i++) {
+    assert(rgb[i] <= MAX_COLOR_COMPONENT);
+    outp(PALETTE_DATA, rgb[i]);
+  }
+}
+
 bool has_mouse() {
   REGS regs;
   regs.x.ax = MOUSE_SETUP;
@@ -1,8 +1,9 @@
 #include "drawing.hpp"
 
+#include <cstdlib>
 #include <cstring>
 
-#include "sprites.hpp"
+#include "assets.hpp"
 
 using std::uint8_t;
 
@@ -13,6 +14,7 @@ void set_pixels(uint8_t *const buffer, int const x, int const y,
 
   if (size > 1) {
     std::memset(buffer + INDEX_OF(x, y), color, size);
+    mark_row(buffer, y);
   } else if (size == 1) {
     // TODO: on old hardware, it might be better to unroll this for small sizes
     // > 1
@@ -29,83 +31,291 @@ void set_pixels_clipped(uint8_t *const buffer, int x, int y,
   set_pixels(buffer, x, y, color, size);
 }
 
-void line(uint8_t *const buffer, int const x1, int const y1, int const x2,
-          int const y2, uint8_t const color) {
-  int x = x1;
-  int y = y1;
+/*
+ * line() steps Bresenham's error term along the major axis and leaves out the
+ * last point. Pixel i of a line that is major steps long and climbs minor has
+ * the minor offset
+ *
+ *   n(i) = (2 * i * minor + major - 1) / (2 * major)
+ *
+ * so the steps that land on screen can be worked out before drawing, and each
+ * run of steps sharing an offset can be drawn as one span. The run at offset n
+ * ends at step
+ *
+ *   last(n) = (2 * n * major + major) / (2 * minor)
+ *
+ * which grows by 2 * major / (2 * minor) per run, give or take a carry, so the
+ * loop below needs no division per run. Intermediate values are long because
+ * they overflow 16 bits.
+ */
+
+struct LineSteps {
+  long first; // first step on screen, or > last if none are
+  long last;
+};
+
+// Limits steps so that start + inc * step stays within [lo, hi]
+static void clip_major(LineSteps &steps, int const start, int const inc,
+                       int const lo, int const hi) {
+  long const near_edge = inc > 0 ? lo - start : start - hi;
+  long const far_edge = inc > 0 ? hi - start : start - lo;
+  steps.first = std::max(steps.first, near_edge);
+  steps.last = std::min(steps.last, far_edge);
+}
+
+// Limits steps so that start + inc * n(step) stays within [lo, hi]
+static void clip_minor(LineSteps &steps, long const major, long const minor,
+                       int const start, int const inc, int const lo,
+                       int const hi) {
+  long const low_n = inc > 0 ? lo - start : start - hi;
+  long const high_n = inc > 0 ? hi - start : start - lo;
+  if (high_n < 0) {
+    steps.last = -1;
+    return;
+  }
+
+  if (low_n > 0) {
+    long const numerator = 2 * major * low_n - major + 1;
+    steps.first =
+        std::max(steps.first, (numerator + 2 * minor - 1) / (2 * minor));
+  }
+  steps.last = std::min(steps.last, (2 * major * high_n + major) / (2 * minor));
+}
+
+// Draws the steps of a line whose major axis is x, one row span per run
+static void draw_shallow(uint8_t *const buffer, int const x1, int const y1,
+                         int const xinc, int const yinc, long const dx,
+                         long const dy, LineSteps const &steps,
+                         uint8_t const color) {
+  long n = (2 * steps.first * dy + dx - 1) / (2 * dx);
+  long const numerator = 2 * n * dx + dx;
+  long run_last = numerator / (2 * dy);
+  long remainder = numerator % (2 * dy);
+  long const run_whole = dx / dy;
+  long const run_fraction = (2 * dx) % (2 * dy);
+
+  for (long i = steps.first; i <= steps.last; n++) {
+    long const end = std::min(run_last, steps.last);
+    int const y = static_cast<int>(y1 + yinc * n);
+    int const x = static_cast<int>(x1 + xinc * (xinc > 0 ? i : end));
+
+    std::memset(buffer + INDEX_OF(x, y), color, end - i + 1);
+    mark_row(buffer, y);
+    i = end + 1;
+
+    run_last += run_whole;
+    remainder += run_fraction;
+    if (remainder >= 2 * dy) {
+      remainder -= 2 * dy;
+      run_last++;
+    }
+  }
+}
 
+// Draws the steps of a line whose major axis is y, one column span per run
+static void draw_steep(uint8_t *const buffer, int const x1, int const y1,
+                       int const xinc, int const yinc, long const dx,
+                       long const dy, LineSteps const &steps,
+                       uint8_t const color) {
+  long n = (2 * steps.first * dx + dy - 1) / (2 * dy);
+  long const numerator = 2 * n * dy + dy;
+  long run_last = numerator / (2 * dx);
+  long remainder = numerator % (2 * dx);
+  long const run_whole = dy / dx;
+  long const run_fraction = (2 * dy) % (2 * dx);
+  int const stride = yinc * SCREEN_WIDTH;
+
+  for (long i = steps.first; i <= steps.last; n++) {
+    long const end = std::min(run_last, steps.last);
+    int const x = static_cast<int>(x1 + xinc * n);
+    int const y = static_cast<int>(y1 + yinc * i);
+
+    uint8_t *pixel = buffer + INDEX_OF(x, y);
+    for (long j = i; j <= end; j++) {
+      *pixel = color;
+      pixel += stride;
+    }
+    i = end + 1;
+
+    run_last += run_whole;
+    remainder += run_fraction;
+    if (remainder >= 2 * dx) {
+      remainder -= 2 * dx;
+      run_last++;
+    }
+  }
+}
+
+void line_in_rows(uint8_t *const buffer, int const x1, int const y1,
+                  int const x2, int const y2, uint8_t const color,
+                  int const first_y, int const last_y) {
   if (y1 == y2) {
-    if (x1 > x2)
-      x = x2;
-    set_pixels_clipped(buffer, x, y, color, std::abs(x2 - x1) + 1);
+    int const y = clamp(y1, 0, MAX_Y);
+    if (y >= first_y && y <= last_y) {
+      set_pixels_clipped(buffer, std::min(x1, x2), y, color,
+                         std::abs(x2 - x1) + 1);
+    }
     return;
   }
 
   int const xinc = (x1 > x2) ? -1 : 1;
-  int const dx = std::abs(x2 - x1);
+  long const dx = std::abs(x2 - x1);
 
   int const yinc = (y1 > y2) ? -1 : 1;
-  int const dy = std::abs(y2 - y1);
+  long const dy = std::abs(y2 - y1);
 
-  int const two_dx = dx + dx;
-  int const two_dy = dy + dy;
-
-  int error = 0;
+  LineSteps steps;
+  steps.first = 0;
 
   if (dx > dy) {
-    error = 0;
-    for (int i = 0; i < dx; i++) {
-      set_pixel_clipped(buffer, x, y, color);
-      x += xinc;
-      error += two_dy;
-      if (error > dx) {
-        error -= two_dx;
-        y += yinc;
-      }
-    }
-  } else {
-    error = 0;
-    for (int i = 0; i < dy; i++) {
-      set_pixel_clipped(buffer, x, y, color);
-      y += yinc;
-      error += two_dx;
-      if (error > dy) {
-        error -= two_dy;
-        x += xinc;
-      }
+    steps.last = dx - 1;
+    clip_major(steps, x1, xinc, 0, MAX_X);
+    clip_minor(steps, dx, dy, y1, yinc, first_y, last_y);
+    if (steps.first <= steps.last)
+      draw_shallow(buffer, x1, y1, xinc, yinc, dx, dy, steps, color);
+    return;
+  }
+
+  steps.last = dy - 1;
+  clip_major(steps, y1, yinc, first_y, last_y);
+  if (dx == 0) {
+    if (x1 < 0 || x1 > MAX_X || steps.first > steps.last)
+      return;
+
+    // Vertical
+    int const top = static_cast<int>(
+        yinc > 0 ? y1 + steps.first : y1 - steps.last);
+    int const count = static_cast<int>(steps.last - steps.first + 1);
+    uint8_t *pixel = buffer + INDEX_OF(x1, top);
+    for (int i = 0; i < count; i++) {
+      *pixel = color;
+      pixel += SCREEN_WIDTH;
     }
+    std::memset(ROW_FLAGS(buffer) + top, 1, count);
+    return;
   }
+
+  clip_minor(steps, dy, dx, x1, xinc, 0, MAX_X);
+  if (steps.first > steps.last)
+    return;
+
+  draw_steep(buffer, x1, y1, xinc, yinc, dx, dy, steps, color);
+  int const start_y = static_cast<int>(y1 + yinc * steps.first);
+  int const end_y = static_cast<int>(y1 + yinc * steps.last);
+  std::memset(ROW_FLAGS(buffer) + std::min(start_y, end_y), 1,
+              std::abs(end_y - start_y) + 1);
 }
 
-void draw_digit(uint8_t *buffer, int const x, int const y, int const digit) {
-  for (int y_loop = 0; y_loop < DIGIT_HEIGHT; y_loop++) {
-    std::memcpy(buffer + INDEX_OF(x, y + y_loop), digit_sprites[digit][y_loop],
-                DIGIT_WIDTH);
-  }
+void line(uint8_t *const buffer, int const x1, int const y1, int const x2,
+          int const y2, uint8_t const color) {
+  line_in_rows(buffer, x1, y1, x2, y2, color, 0, MAX_Y);
 }
 
-void draw_number(uint8_t *const buffer, int x, int const y, int number) {
-  if (number < 0) {
-    // TODO: ascii table (maybe I should use cogp47?)
-    int const dash_y = y + (DIGIT_HEIGHT >> 1);
-    line(buffer, x, dash_y, x + 4, dash_y, MAX_COLOR);
-    number *= -1;
-    x += 5;
+void lines(uint8_t *const buffer, Segment const *const segments,
+           int const count, uint8_t const color) {
+  for (int i = 0; i < count; i++) {
+    Segment const &segment = segments[i];
+    line(buffer, segment.x1, segment.y1, segment.x2, segment.y2, color);
   }
+}
 
-  if (number < 10) {
-    draw_digit(buffer, x, y, number);
+void set_text(TextRun &run, char const *const text) {
+  if (run.width >= 0 &&
+      !std::strncmp(run.text, text, MAX_TEXT_LENGTH + 1)) // already laid out
     return;
+
+  int length = 0;
+  while (length < MAX_TEXT_LENGTH && text[length]) {
+    run.text[length] = text[length];
+    length++;
   }
+  run.text[length] = '\0';
+  run.width = length ? length * GLYPH_SPACING - 1 : 0;
+
+  for (int y = 0; y < GLYPH_HEIGHT; y++) {
+    uint8_t *mask = run.mask[y];
+    for (int i = 0; i < length; i++) {
+      int const c = static_cast<unsigned char>(run.text[i]);
+      int const index =
+          (c >= FIRST_GLYPH && c <= LAST_GLYPH ? c : '?') - FIRST_GLYPH;
+      uint8_t const bits = glyphs[index][y];
 
-  int divisor = 10000; // Max 16-bit power of 10
-  while (divisor > number) {
-    divisor /= 10;
+      for (int x = GLYPH_WIDTH - 1; x >= 0; x--) {
+        *mask++ = (bits >> x) & 1 ? 0xff : 0;
+      }
+      *mask++ = 0; // spacing
+    }
   }
+}
+
+void draw_run_in_rows(uint8_t *const buffer, int const x, int const y,
+                      TextRun const &run, uint8_t const color,
+                      int const first_y, int const last_y) {
+  int const left = std::max(x, 0);
+  int const right = std::min(x + run.width, static_cast<int>(SCREEN_WIDTH));
+  int const top = std::max(y, first_y);
+  int const bottom = std::min(y + GLYPH_HEIGHT, last_y + 1);
+  int const count = right - left;
+  if (count <= 0)
+    return;
+
+  std::uint32_t const fill = color * 0x01010101UL;
+
+  for (int row = top; row < bottom; row++) {
+    uint8_t *const dest = buffer + INDEX_OF(left, row);
+    uint8_t const *const mask = run.mask[row - y] + (left - x);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      std::uint32_t bits;
+      std::memcpy(&bits, mask + i, 4);
+      if (bits) {
+        std::uint32_t pixels;
+        std::memcpy(&pixels, dest + i, 4);
+        pixels = (pixels & ~bits) | (fill & bits);
+        std::memcpy(dest + i, &pixels, 4);
+      }
+    }
+    for (; i < count; i++) {
+      if (mask[i])
+        dest[i] = color;
+    }
+    mark_row(buffer, row);
+  }
+}
+
+void draw_run(uint8_t *const buffer, int const x, int const y,
+              TextRun const &run, uint8_t const color) {
+  draw_run_in_rows(buffer, x, y, run, color, 0, MAX_Y);
+}
+
+void draw_text(uint8_t *const buffer, int const x, int const y,
+               char const *const text, TextRun &run, uint8_t const color) {
+  set_text(run, text);
+  draw_run(buffer, x, y, run, color);
+}
+
+void set_number_text(TextRun &run, long const number) {
+  char digits[sizeof(long) * 3 + 2]; // 3 chars per byte is enough, plus sign
+  char *text = digits + sizeof(digits) - 1;
+  *text = '\0';
+
+  // negate one digit at a time so LONG_MIN doesn't overflow
+  long rest = number;
   do {
-    draw_digit(buffer, x, y, number / divisor);
-    x += DIGIT_SPACING;
-    number %= divisor;
-    divisor /= 10;
-  } while (divisor > 0);
+    long const digit = rest % 10;
+    *--text = static_cast<char>('0' + (digit < 0 ? -digit : digit));
+    rest /= 10;
+  } while (rest);
+  if (number < 0) {
+    *--text = '-';
+  }
+
+  set_text(run, text);
+}
+
+void draw_number(uint8_t *const buffer, int const x, int const y,
+                 long const number, TextRun &run, uint8_t const color) {
+  set_number_text(run, number);
+  draw_run(buffer, x, y, run, color);
 }
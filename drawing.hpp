@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cstdint>
 
+#include "sprites.hpp"
 #include "system.hpp"
 
 using std::uint8_t;
@@ -18,7 +19,17 @@ using std::uint8_t;
 
 #define MAX_COLOR (NUM_COLORS - 1)
 
-#define DIGIT_SPACING (DIGIT_WIDTH + 1)
+#define MAX_TEXT_LENGTH 32
+#define MAX_TEXT_WIDTH (MAX_TEXT_LENGTH * GLYPH_SPACING)
+
+// Frame buffers are followed by a guard that is always clear, then one flag
+// per row, set when the row may hold nonzero pixels. blur() skips rows whose
+// sources are all clear, so anything that writes pixels must mark the rows it
+// touches. Buffers from alloc_frame_buffer() have a guard in front too, so
+// the blur's reads of a row's neighbours never leave the buffer.
+#define FRAME_GUARD_SIZE (SCREEN_WIDTH + 64) // a row and the widest load
+#define FRAME_BUFFER_SIZE (SCREEN_SIZE + FRAME_GUARD_SIZE + SCREEN_HEIGHT)
+#define ROW_FLAGS(buffer) ((buffer) + SCREEN_SIZE + FRAME_GUARD_SIZE)
 
 #define assert_minmax(x, min, max)                                             \
   assert((x) >= (min));                                                        \
@@ -34,11 +45,16 @@ template <typename T> inline uint8_t clamp_color(T const color) {
   return static_cast<uint8_t>(clamp<T>(color, 0, MAX_COLOR_COMPONENT));
 }
 
+inline void mark_row(uint8_t *const buffer, int const y) {
+  ROW_FLAGS(buffer)[y] = 1;
+}
+
 inline void set_pixel(uint8_t *const buffer, int const x, int const y,
                       uint8_t const color) {
   assert_onscreen(x, y);
 
   buffer[INDEX_OF(x, y)] = color;
+  mark_row(buffer, y);
 }
 
 inline void set_pixel_clipped(uint8_t *const buffer, int const x, int const y,
@@ -53,10 +69,58 @@ void set_pixels(std::uint8_t *const buffer, int const x, int const y,
 void set_pixels_clipped(std::uint8_t *const buffer, int x, int y,
                         std::uint8_t const color, int size);
 
+struct Segment {
+  int x1, y1;
+  int x2, y2;
+};
+
+// Clipped to the screen. Lines that aren't horizontal stop one pixel short of
+// (x2, y2).
 void line(std::uint8_t *const buffer, int const x1, int const y1, int const x2,
           int const y2, std::uint8_t const color);
 
-void draw_digit(std::uint8_t *buffer, int const x, int const y,
-                int const digit);
-
-void draw_number(std::uint8_t *const buffer, int x, int const y, int number);
+void lines(std::uint8_t *const buffer, Segment const *const segments,
+           int const count, std::uint8_t const color);
+
+// As line(), but only draws rows first_y to last_y. Drawing a line a band of
+// rows at a time gives the same pixels as drawing it whole.
+void line_in_rows(std::uint8_t *const buffer, int const x1, int const y1,
+                  int const x2, int const y2, std::uint8_t const color,
+                  int const first_y, int const last_y);
+
+// A string laid out as one mask byte per pixel, 0xff where it is lit, so it
+// can be blitted a word at a time. Keep one for each string drawn every frame;
+// set_text() only lays it out again when the string changes.
+struct TextRun {
+  char text[MAX_TEXT_LENGTH + 1];
+  int width; // -1 until the first set_text()
+  std::uint8_t mask[GLYPH_HEIGHT][MAX_TEXT_WIDTH];
+
+  TextRun() : width(-1) {}
+};
+
+// Characters outside FIRST_GLYPH..LAST_GLYPH are drawn as '?', and anything
+// past MAX_TEXT_LENGTH is dropped.
+void set_text(TextRun &run, char const *const text);
+
+// Draws the lit pixels of run and leaves the rest of the buffer alone. Clipped
+// to the screen.
+void draw_run(std::uint8_t *const buffer, int const x, int const y,
+              TextRun const &run, std::uint8_t const color);
+
+void draw_run_in_rows(std::uint8_t *const buffer, int const x, int const y,
+                      TextRun const &run, std::uint8_t const color,
+                      int const first_y, int const last_y);
+
+// For text that changes often, such as debug output. Laid out into the
+// caller's run, which it keeps from frame to frame like draw_number()'s, so
+// drawing on several threads at once is safe as long as each has its own.
+void draw_text(std::uint8_t *const buffer, int const x, int const y,
+               char const *const text, TextRun &run,
+               std::uint8_t const color = MAX_COLOR);
+
+void set_number_text(TextRun &run, long const number);
+
+void draw_number(std::uint8_t *const buffer, int const x, int const y,
+                 long const number, TextRun &run,
+                 std::uint8_t const color = MAX_COLOR);
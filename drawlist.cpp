@@ -0,0 +1,290 @@
+#include "drawlist.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "arena.hpp"
+#include "workers.hpp"
+
+using std::uint8_t;
+
+struct DrawJob {
+  DrawList const *list;
+  uint8_t *buffer;
+};
+
+/*
+ * A list or a point set is one piece of the arena, its arrays one after
+ * another, each on an ARENA_ALIGN boundary. On DOS that keeps each to one of
+ * the arena's few blocks.
+ */
+
+// What an array of count Ts takes up in the piece
+template <typename T> static long array_span(long const count) {
+  return arena_span(static_cast<long>(sizeof(T)) * count);
+}
+
+// Hands out the next array of the piece at next
+template <typename T> static T *take_array(uint8_t *&next, long const count) {
+  T *const items = reinterpret_cast<T *>(next);
+  next += array_span<T>(count);
+  return items;
+}
+
+// Two extra starts so the binning can count and place in the same array
+#define NUM_BAND_STARTS (NUM_DRAW_BANDS + 2)
+
+long point_set_arena_size(int const capacity) {
+  return 2 * array_span<PixelOffset>(capacity) +
+         2 * array_span<short>(capacity) + array_span<int>(NUM_BAND_STARTS);
+}
+
+void init_point_set(PointSet &points, int const capacity) {
+  uint8_t *next =
+      static_cast<uint8_t *>(arena_alloc(point_set_arena_size(capacity)));
+  points.capacity = capacity;
+  points.offsets = take_array<PixelOffset>(next, capacity);
+  points.ys = take_array<short>(next, capacity);
+  points.band_starts = take_array<int>(next, NUM_BAND_STARTS);
+  points.added_offsets = take_array<PixelOffset>(next, capacity);
+  points.added_ys = take_array<short>(next, capacity);
+  clear_points(points);
+}
+
+// The same counting sort as bin_draw_list(), with one band per point
+void bin_points(PointSet &points) {
+  int *const starts = points.band_starts;
+  std::memset(starts, 0, NUM_BAND_STARTS * sizeof(int));
+
+  for (int i = 0; i < points.count; i++) {
+    starts[points.added_ys[i] / DRAW_BAND_ROWS + 2]++;
+  }
+  for (int band = 0; band < NUM_DRAW_BANDS; band++) {
+    starts[band + 2] += starts[band + 1];
+  }
+
+  for (int i = 0; i < points.count; i++) {
+    int const slot = starts[points.added_ys[i] / DRAW_BAND_ROWS + 1]++;
+    points.offsets[slot] = points.added_offsets[i];
+    points.ys[slot] = points.added_ys[i];
+  }
+}
+
+long draw_list_arena_size() {
+  return array_span<DrawCommand>(MAX_DRAW_COMMANDS) +
+         array_span<int>(NUM_BAND_STARTS) +
+         array_span<int>(static_cast<long>(MAX_DRAW_COMMANDS) * NUM_DRAW_BANDS);
+}
+
+void init_draw_list(DrawList &list) {
+  // Zeroed, so an empty list's bands are already empty
+  uint8_t *next = static_cast<uint8_t *>(arena_alloc(draw_list_arena_size()));
+  list.commands = take_array<DrawCommand>(next, MAX_DRAW_COMMANDS);
+  list.num_commands = 0;
+  list.band_starts = take_array<int>(next, NUM_BAND_STARTS);
+  list.band_commands = take_array<int>(
+      next, static_cast<long>(MAX_DRAW_COMMANDS) * NUM_DRAW_BANDS);
+}
+
+void clear_draw_list(DrawList &list) { list.num_commands = 0; }
+
+static DrawCommand &add_command(DrawList &list, DrawKind const kind,
+                                uint8_t const color) {
+  if (list.num_commands == MAX_DRAW_COMMANDS) {
+    std::cerr << "More than " << MAX_DRAW_COMMANDS
+              << " draw commands in a frame.\n";
+    std::exit(1);
+  }
+
+  DrawCommand &command = list.commands[list.num_commands++];
+  command.kind = static_cast<uint8_t>(kind);
+  command.color = color;
+  command.text = NULL;
+  return command;
+}
+
+void record_pixel(DrawList &list, int const x, int const y,
+                  uint8_t const color) {
+  DrawCommand &command = add_command(list, kDrawPixel, color);
+  command.x1 = x;
+  command.y1 = y;
+}
+
+void record_pixels(DrawList &list, int const x, int const y,
+                   uint8_t const color, int const size) {
+  assert_onscreen(x, y);
+  assert_minmax(size, 0, MAX_X - x + 1);
+
+  DrawCommand &command = add_command(list, kDrawPixels, color);
+  command.x1 = x;
+  command.y1 = y;
+  command.x2 = size;
+}
+
+void record_line(DrawList &list, int const x1, int const y1, int const x2,
+                 int const y2, uint8_t const color) {
+  DrawCommand &command = add_command(list, kDrawLine, color);
+  command.x1 = x1;
+  command.y1 = y1;
+  command.x2 = x2;
+  command.y2 = y2;
+}
+
+void record_lines(DrawList &list, Segment const *const segments,
+                  int const count, uint8_t const color) {
+  for (int i = 0; i < count; i++) {
+    Segment const &segment = segments[i];
+    record_line(list, segment.x1, segment.y1, segment.x2, segment.y2, color);
+  }
+}
+
+void record_text(DrawList &list, int const x, int const y, TextRun const &run,
+                 uint8_t const color) {
+  DrawCommand &command = add_command(list, kDrawText, color);
+  command.x1 = x;
+  command.y1 = y;
+  command.text = &run;
+}
+
+void record_number(DrawList &list, int const x, int const y, long const number,
+                   TextRun &run, uint8_t const color) {
+  set_number_text(run, number);
+  record_text(list, x, y, run, color);
+}
+
+void record_points(DrawList &list, PointSet const &points,
+                   uint8_t const color) {
+  DrawCommand &command = add_command(list, kDrawPoints, color);
+  command.points = &points;
+}
+
+// Finds the rows a command can touch. Returns false if it draws nothing.
+static bool command_rows(DrawCommand const &command, int &top, int &bottom) {
+  switch (command.kind) {
+  case kDrawPixel:
+    if (!IS_ONSCREEN(command.x1, command.y1))
+      return false;
+    top = bottom = command.y1;
+    return true;
+
+  case kDrawPixels:
+    top = bottom = command.y1;
+    return command.x2 > 0;
+
+  case kDrawLine:
+    if (command.y1 == command.y2) {
+      // Horizontal lines are clamped onto the screen, not clipped
+      top = bottom = clamp(command.y1, 0, MAX_Y);
+      return true;
+    }
+    top = std::max(std::min(command.y1, command.y2), 0);
+    bottom = std::min(std::max(command.y1, command.y2), MAX_Y);
+    return top <= bottom;
+
+  case kDrawText:
+    top = std::max(command.y1, 0);
+    bottom = std::min(command.y1 + GLYPH_HEIGHT - 1, MAX_Y);
+    return top <= bottom && command.text->width > 0;
+
+  case kDrawPoints:
+    top = command.points->top;
+    bottom = command.points->bottom;
+    return top <= bottom;
+  }
+  return false;
+}
+
+void bin_draw_list(DrawList &list) {
+  int *const starts = list.band_starts;
+  std::memset(starts, 0, NUM_BAND_STARTS * sizeof(int));
+
+  // Count each band's commands two places along, so that after the prefix sum
+  // starts[b + 1] is where band b begins
+  for (int i = 0; i < list.num_commands; i++) {
+    int top, bottom;
+    if (!command_rows(list.commands[i], top, bottom))
+      continue;
+
+    int const last_band = bottom / DRAW_BAND_ROWS;
+    for (int band = top / DRAW_BAND_ROWS; band <= last_band; band++) {
+      starts[band + 2]++;
+    }
+  }
+  for (int band = 0; band < NUM_DRAW_BANDS; band++) {
+    starts[band + 2] += starts[band + 1];
+  }
+
+  // Placing them in recorded order moves starts[b + 1] to where band b ends,
+  // which is where band b + 1 begins
+  for (int i = 0; i < list.num_commands; i++) {
+    int top, bottom;
+    if (!command_rows(list.commands[i], top, bottom))
+      continue;
+
+    int const last_band = bottom / DRAW_BAND_ROWS;
+    for (int band = top / DRAW_BAND_ROWS; band <= last_band; band++) {
+      list.band_commands[starts[band + 1]++] = i;
+    }
+  }
+}
+
+static void draw_points(uint8_t *const buffer, PointSet const &points,
+                        uint8_t const color, int const band) {
+  int const end = points.band_starts[band + 1];
+  for (int i = points.band_starts[band]; i < end; i++) {
+    buffer[points.offsets[i]] = color;
+    mark_row(buffer, points.ys[i]);
+  }
+}
+
+void draw_band(DrawList const &list, uint8_t *const buffer, int const band) {
+  int const first_y = band * DRAW_BAND_ROWS;
+  int const last_y = std::min(first_y + DRAW_BAND_ROWS, SCREEN_HEIGHT) - 1;
+
+  int const end = list.band_starts[band + 1];
+  for (int i = list.band_starts[band]; i < end; i++) {
+    DrawCommand const &command = list.commands[list.band_commands[i]];
+
+    switch (command.kind) {
+    case kDrawPixel:
+      set_pixel(buffer, command.x1, command.y1, command.color);
+      break;
+
+    case kDrawPixels:
+      set_pixels(buffer, command.x1, command.y1, command.color, command.x2);
+      break;
+
+    case kDrawLine:
+      line_in_rows(buffer, command.x1, command.y1, command.x2, command.y2,
+                   command.color, first_y, last_y);
+      break;
+
+    case kDrawText:
+      draw_run_in_rows(buffer, command.x1, command.y1, *command.text,
+                       command.color, first_y, last_y);
+      break;
+
+    case kDrawPoints:
+      draw_points(buffer, *command.points, command.color, band);
+      break;
+    }
+  }
+}
+
+static void draw_band_task(void *const context, int const band) {
+  DrawJob const &job = *static_cast<DrawJob const *>(context);
+  draw_band(*job.list, job.buffer, band);
+}
+
+void draw_list(DrawList &list, uint8_t *const buffer) {
+  if (!list.num_commands)
+    return;
+
+  bin_draw_list(list);
+
+  DrawJob job;
+  job.list = &list;
+  job.buffer = buffer;
+  run_tasks(draw_band_task, &job, NUM_DRAW_BANDS);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+
+#include "drawing.hpp"
+#include "tables.hpp"
+
+/*
+ * Deferred drawing
+ *
+ * Render hooks record primitives into a DrawList instead of drawing them.
+ * Once a frame is recorded the commands are binned by the bands of rows they
+ * touch, and each band is drawn on its own: only its commands, clipped to its
+ * rows, in the order they were recorded. Bands can then be drawn in parallel
+ * with each one's pixels staying in cache, and drawing every band gives the
+ * same frame as drawing the commands directly.
+ *
+ * Lists and point sets take fixed storage from the frame arena when they are
+ * set up, so recording a frame never allocates. Clearing one just starts it
+ * over.
+ */
+
+#define DRAW_BAND_ROWS 8
+#define NUM_DRAW_BANDS ((SCREEN_HEIGHT + DRAW_BAND_ROWS - 1) / DRAW_BAND_ROWS)
+#define MAX_DRAW_COMMANDS 128 // per list; the dots record the most, 24
+
+enum DrawKind { kDrawPixel, kDrawPixels, kDrawLine, kDrawText, kDrawPoints };
+
+// Onscreen pixels of one color, sorted by band so each band only visits its
+// own. Fill with clear_points(), add_point() and bin_points().
+struct PointSet {
+  int count;
+  int capacity;
+
+  // Band b's points are [band_starts[b], band_starts[b + 1]) once binned
+  PixelOffset *offsets;
+  short *ys;
+  int *band_starts;
+  int top, bottom; // rows spanned, top > bottom if there are none
+
+  // As added, before binning
+  PixelOffset *added_offsets;
+  short *added_ys;
+};
+
+struct DrawCommand {
+  std::uint8_t kind;
+  std::uint8_t color;
+  int x1, y1;
+  int x2, y2; // kDrawPixels keeps its size in x2
+  union {
+    TextRun const *text;    // kDrawText
+    PointSet const *points; // kDrawPoints
+  };
+};
+
+struct DrawList {
+  DrawCommand *commands; // MAX_DRAW_COMMANDS
+  int num_commands;
+
+  // Band b draws commands[band_commands[i]] for i in
+  // [band_starts[b], band_starts[b + 1]), set up by bin_draw_list(). There is
+  // room for every command in every band.
+  int *band_starts;
+  int *band_commands;
+};
+
+// What init_draw_list() takes from the frame arena
+long draw_list_arena_size();
+
+// Call once the arena is started, from one thread at a time. Recording more
+// than MAX_DRAW_COMMANDS into a list exits.
+void init_draw_list(DrawList &list);
+void clear_draw_list(DrawList &list);
+
+// Clipped to the screen when drawn
+void record_pixel(DrawList &list, int const x, int const y,
+                  std::uint8_t const color);
+
+// As set_pixels(); must be on screen
+void record_pixels(DrawList &list, int const x, int const y,
+                   std::uint8_t const color, int const size);
+
+void record_line(DrawList &list, int const x1, int const y1, int const x2,
+                 int const y2, std::uint8_t const color);
+
+void record_lines(DrawList &list, Segment const *const segments,
+                  int const count, std::uint8_t const color);
+
+// run must stay unchanged until the list is drawn
+void record_text(DrawList &list, int const x, int const y, TextRun const &run,
+                 std::uint8_t const color);
+
+// As draw_number()
+void record_number(DrawList &list, int const x, int const y, long const number,
+                   TextRun &run, std::uint8_t const color = MAX_COLOR);
+
+// What init_point_set() takes from the frame arena
+long point_set_arena_size(int const capacity);
+
+// As init_draw_list(), for up to capacity points
+void init_point_set(PointSet &points, int const capacity);
+
+inline void clear_points(PointSet &points) {
+  points.count = 0;
+  points.top = SCREEN_HEIGHT;
+  points.bottom = -1;
+}
+
+// Up to capacity points, which must be on screen
+inline void add_point(PointSet &points, int const x, int const y) {
+  assert_onscreen(x, y);
+  assert(points.count < points.capacity);
+
+  points.added_offsets[points.count] =
+      static_cast<PixelOffset>(static_cast<PixelOffset>(y) * SCREEN_WIDTH + x);
+  points.added_ys[points.count] = static_cast<short>(y);
+  points.count++;
+  points.top = std::min(points.top, y);
+  points.bottom = std::max(points.bottom, y);
+}
+
+void bin_points(PointSet &points);
+
+// points must be binned and stay unchanged until the list is drawn
+void record_points(DrawList &list, PointSet const &points,
+                   std::uint8_t const color);
+
+// Sorts the recorded commands into bands. Must be called before draw_band().
+void bin_draw_list(DrawList &list);
+
+// Draws the commands touching rows band * DRAW_BAND_ROWS onwards
+void draw_band(DrawList const &list, std::uint8_t *const buffer,
+               int const band);
+
+// Bins the list and draws every band on the worker pool
+void draw_list(DrawList &list, std::uint8_t *const buffer);
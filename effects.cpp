@@ -0,0 +1,48 @@
+#include "effects.hpp"
+
+void none(DrawList &, Rnd &) {}
+
+void wave_effect(DrawList &list, Rnd &rnd) {
+  Segment segments[WAVE_SEGMENTS + 1];
+  int y1 = get_rnd(rnd) % 60 + 60;
+  int const dx = SCREEN_WIDTH / WAVE_SEGMENTS;
+
+  for (int i = 0; i <= WAVE_SEGMENTS; i++) {
+    Segment &segment = segments[i];
+    segment.x1 = i * dx;
+    segment.y1 = y1;
+    segment.x2 = i * dx + dx;
+    segment.y2 = y1 = get_rnd(rnd) % 60 + 60;
+  }
+  record_lines(list, segments, WAVE_SEGMENTS + 1, 128);
+}
+
+void dot_effect(DrawList &list, Rnd &rnd) {
+  for (int i = 0; i < 8; i++) {
+    int const drop_x = get_rnd(rnd) % (SCREEN_WIDTH - 3);
+    int const drop_y = get_rnd(rnd) % (SCREEN_HEIGHT - 3);
+
+    // top-mid
+    record_pixel(list, drop_x + 1, drop_y, MAX_COLOR);
+
+    // middle row
+    record_pixels(list, drop_x, drop_y + 1, MAX_COLOR, 3);
+
+    // bottom mid
+    record_pixel(list, drop_x + 1, drop_y + 2, MAX_COLOR);
+  }
+}
+
+void line_effect(DrawList &list, Rnd &rnd) {
+  // One statement each, so every compiler draws them in the same order
+  int const x1 = get_rnd(rnd) % SCREEN_WIDTH;
+  int const y1 = get_rnd(rnd) % SCREEN_HEIGHT;
+  int const x2 = get_rnd(rnd) % SCREEN_WIDTH;
+  int const y2 = get_rnd(rnd) % SCREEN_HEIGHT;
+  record_line(list, x1, y1, x2, y2,
+              static_cast<uint8_t>(get_rnd(rnd) % NUM_COLORS));
+}
+
+EffectFunc const effects[NUM_EFFECTS] = {none, dot_effect, line_effect,
+                                         wave_effect};
+char const *const effect_names[NUM_EFFECTS] = {"none", "dots", "line", "wave"};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "drawlist.hpp"
+#include "rnd.hpp"
+
+/*
+ * Background effects
+ *
+ * Each round picks one of these to record into the back buffer's draw list
+ * every frame, where blur() smears it into the plasma.
+ */
+
+#define NUM_EFFECTS 4
+#define WAVE_SEGMENTS 10
+
+// Effects draw only from rnd, so they can be run anywhere in any order
+typedef void (*EffectFunc)(DrawList &, Rnd &);
+
+void none(DrawList &, Rnd &);
+void wave_effect(DrawList &list, Rnd &rnd);
+void dot_effect(DrawList &list, Rnd &rnd);
+void line_effect(DrawList &list, Rnd &rnd);
+
+extern EffectFunc const effects[NUM_EFFECTS];
+extern char const *const effect_names[NUM_EFFECTS];
@@ -0,0 +1,285 @@
+#include "feedback.hpp"
+
+#include <algorith> // <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "blur.hpp"
+#include "drawing.hpp"
+#include "tables.hpp"
+#include "workers.hpp"
+
+#define ROTATE_ANGLE 0.02 // radians a frame
+#define SWIRL_ANGLE 0.08  // in the middle, down to none at the corners
+#define TUNNEL_PULL 0.06  // extra zoom at the corners
+
+#define TILES_PER_BAND                                                         \
+  ((SCREEN_WIDTH + FEEDBACK_TILE_WIDTH - 1) / FEEDBACK_TILE_WIDTH)
+
+char const *const feedback_names[kNumFeedbackKinds] = {
+    "zoom", "rotate", "swirl", "tunnel", "ball_zoom",
+};
+
+#ifdef PP_HOST
+
+static bool is_allocated(FeedbackMap const &map) {
+  return map.offsets != NULL;
+}
+
+void init_feedback_map(FeedbackMap &map) {
+  map.kind = kFeedbackZoom;
+  map.center_x = MID_X;
+  map.center_y = MID_Y;
+  map.rows_built = 0;
+  map.offsets = NULL;
+  map.first_rows = NULL;
+  map.last_rows = NULL;
+  map.tile_order = NULL;
+  map.tile_sources = NULL;
+}
+
+static void allocate_map(FeedbackMap &map) {
+  map.offsets = new Displacement[SCREEN_SIZE];
+  map.first_rows = new short[SCREEN_HEIGHT];
+  map.last_rows = new short[SCREEN_HEIGHT];
+  map.tile_order = new unsigned short[NUM_BLUR_BANDS * TILES_PER_BAND];
+  map.tile_sources = new TileSources[SCREEN_HEIGHT * TILES_PER_BAND];
+  if (map.offsets == NULL || map.first_rows == NULL ||
+      map.last_rows == NULL || map.tile_order == NULL ||
+      map.tile_sources == NULL) {
+    std::cerr << "Not enough memory for feedback maps.\n";
+    std::exit(1);
+  }
+}
+
+void free_feedback_map(FeedbackMap &map) {
+  delete[] map.offsets;
+  delete[] map.first_rows;
+  delete[] map.last_rows;
+  delete[] map.tile_order;
+  delete[] map.tile_sources;
+  map.offsets = NULL;
+  map.first_rows = NULL;
+  map.last_rows = NULL;
+  map.tile_order = NULL;
+  map.tile_sources = NULL;
+}
+
+static void start_map(FeedbackMap &map, int const kind, int const x,
+                      int const y) {
+  if (!is_allocated(map)) {
+    allocate_map(map);
+  }
+  map.kind = kind;
+  map.center_x = x;
+  map.center_y = y;
+  map.rows_built = 0;
+}
+
+static void build_row(FeedbackMap &map, int const y) {
+  double const cx = map.center_x;
+  double const cy = map.center_y;
+  double const corner = std::sqrt(static_cast<double>(MID_X) * MID_X +
+                                  static_cast<double>(MID_Y) * MID_Y);
+  double const v = y - cy;
+
+  Displacement *const row = map.offsets + INDEX_OF(0, y);
+  TileSources *const tiles = map.tile_sources + y * TILES_PER_BAND;
+  int first_row = MAX_Y;
+  int last_row = 0;
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    double const u = x - cx;
+    double const radius = std::sqrt(u * u + v * v) / corner;
+
+    // Where the source is, from the center
+    double angle = 0;
+    double scale = 1 / ZOOM;
+    switch (map.kind) {
+    case kFeedbackRotate:
+      angle = ROTATE_ANGLE;
+      break;
+    case kFeedbackSwirl:
+      angle = SWIRL_ANGLE * std::max(0.0, 1 - radius);
+      break;
+    case kFeedbackTunnel:
+      scale = 1 / (ZOOM + TUNNEL_PULL * radius);
+      break;
+    }
+    double const c = std::cos(angle) * scale;
+    double const s = std::sin(angle) * scale;
+    double const su = u * c - v * s;
+    double const sv = u * s + v * c;
+
+    int source_x = static_cast<int>(std::floor(cx + su + .5));
+    int source_y = static_cast<int>(std::floor(cy + sv + .5));
+    if (map.kind == kFeedbackZoom) {
+      // Exactly the separable zoom, which blur() is checked against
+      source_x = static_cast<int>(target_x[x]);
+      source_y = static_cast<int>(target_y[y] / SCREEN_WIDTH);
+    }
+    source_x = clamp(source_x, 1, SCREEN_WIDTH - 2);
+    source_y = clamp(source_y, 1, SCREEN_HEIGHT - 2);
+    row[x].dx = static_cast<std::int16_t>(source_x - x);
+    row[x].dy = static_cast<std::int16_t>(source_y - y);
+    first_row = std::min(first_row, source_y);
+    last_row = std::max(last_row, source_y);
+
+    TileSources &sources = tiles[x / FEEDBACK_TILE_WIDTH];
+    if (x % FEEDBACK_TILE_WIDTH == 0) {
+      sources.first_x = sources.last_x = static_cast<short>(source_x);
+      sources.first_y = sources.last_y = static_cast<short>(source_y);
+    }
+    sources.first_x = std::min(sources.first_x, static_cast<short>(source_x));
+    sources.last_x = std::max(sources.last_x, static_cast<short>(source_x));
+    sources.first_y = std::min(sources.first_y, static_cast<short>(source_y));
+    sources.last_y = std::max(sources.last_y, static_cast<short>(source_y));
+  }
+  map.first_rows[y] = static_cast<short>(first_row);
+  map.last_rows[y] = static_cast<short>(last_row);
+}
+
+struct TileKey {
+  long source; // offset of the source of the tile's middle
+  unsigned short tile;
+
+  bool operator<(TileKey const &other) const { return source < other.source; }
+};
+
+static void order_tiles(FeedbackMap &map) {
+  TileKey *const keys = new TileKey[TILES_PER_BAND];
+  if (keys == NULL) {
+    std::cerr << "Not enough memory for feedback maps.\n";
+    std::exit(1);
+  }
+
+  for (int band = 0; band < NUM_BLUR_BANDS; band++) {
+    int const y =
+        std::min(band * BLUR_BAND_ROWS + BLUR_BAND_ROWS / 2, MAX_Y);
+    for (int tile = 0; tile < TILES_PER_BAND; tile++) {
+      int const x = std::min(tile * FEEDBACK_TILE_WIDTH +
+                                 FEEDBACK_TILE_WIDTH / 2,
+                             MAX_X);
+      Displacement const offset = map.offsets[INDEX_OF(x, y)];
+      keys[tile].source = INDEX_OF(x + offset.dx, static_cast<long>(y) +
+                                                      offset.dy);
+      keys[tile].tile = static_cast<unsigned short>(tile);
+    }
+    std::sort(keys, keys + TILES_PER_BAND);
+    for (int tile = 0; tile < TILES_PER_BAND; tile++) {
+      map.tile_order[band * TILES_PER_BAND + tile] = keys[tile].tile;
+    }
+  }
+  delete[] keys;
+}
+
+struct BuildJob {
+  FeedbackMap *map;
+  int first_y;
+};
+
+static void build_row_task(void *const context, int const index) {
+  BuildJob const &job = *static_cast<BuildJob const *>(context);
+  build_row(*job.map, job.first_y + index);
+}
+
+// Builds up to count more rows. Returns true once the map is done.
+static bool build_rows(FeedbackMap &map, int const count) {
+  BuildJob job;
+  job.map = &map;
+  job.first_y = map.rows_built;
+
+  int const rows = std::min(count, SCREEN_HEIGHT - map.rows_built);
+  run_tasks(build_row_task, &job, rows);
+  map.rows_built += rows;
+
+  if (map.rows_built < SCREEN_HEIGHT)
+    return false;
+
+  order_tiles(map);
+  return true;
+}
+
+void build_feedback_map(FeedbackMap &map, int const kind, int const x,
+                        int const y) {
+  start_map(map, kind, x, y);
+  build_rows(map, SCREEN_HEIGHT);
+}
+
+void init_feedback(Feedback &feedback) {
+  init_feedback_map(feedback.maps[0]);
+  init_feedback_map(feedback.maps[1]);
+  feedback.active = NULL;
+  feedback.building = NULL;
+  feedback.kind = kFeedbackZoom;
+  feedback.center_x = MID_X;
+  feedback.center_y = MID_Y;
+}
+
+void free_feedback(Feedback &feedback) {
+  free_feedback_map(feedback.maps[0]);
+  free_feedback_map(feedback.maps[1]);
+  feedback.active = NULL;
+  feedback.building = NULL;
+}
+
+static bool is_map_of(FeedbackMap const *const map, int const kind,
+                      int const x, int const y) {
+  return map && map->kind == kind && map->center_x == x &&
+         map->center_y == y;
+}
+
+void request_feedback(Feedback &feedback, int const kind, int const ball_x,
+                      int const ball_y) {
+  // Only the ball's zoom moves
+  int const x = kind == kFeedbackBallZoom ? ball_x : MID_X;
+  int const y = kind == kFeedbackBallZoom ? ball_y : MID_Y;
+  if (kind == feedback.kind && x == feedback.center_x &&
+      y == feedback.center_y)
+    return;
+
+  feedback.kind = kind;
+  feedback.center_x = x;
+  feedback.center_y = y;
+  feedback.building = NULL;
+
+  if (kind == kFeedbackZoom) {
+    feedback.active = NULL;
+  } else if (!is_map_of(feedback.active, kind, x, y)) {
+    FeedbackMap &spare = feedback.active == &feedback.maps[0]
+                             ? feedback.maps[1]
+                             : feedback.maps[0];
+    start_map(spare, kind, x, y);
+    feedback.building = &spare;
+  }
+}
+
+void step_feedback(Feedback &feedback) {
+  if (!feedback.building)
+    return;
+
+  int const rows =
+      (SCREEN_HEIGHT + FEEDBACK_BUILD_FRAMES - 1) / FEEDBACK_BUILD_FRAMES;
+  if (build_rows(*feedback.building, rows)) {
+    feedback.active = feedback.building;
+    feedback.building = NULL;
+  }
+}
+
+#else
+
+void init_feedback(Feedback &feedback) {
+  feedback.active = NULL;
+  feedback.building = NULL;
+  feedback.kind = kFeedbackZoom;
+  feedback.center_x = MID_X;
+  feedback.center_y = MID_Y;
+}
+
+void free_feedback(Feedback &) {}
+
+void request_feedback(Feedback &, int const, int const, int const) {}
+
+void step_feedback(Feedback &) {}
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+#include "system.hpp"
+
+/*
+ * Feedback maps
+ *
+ * Each frame is the last one pulled through a map that gives every pixel the
+ * pixel it is blurred from. The classic zoom towards the middle is separable,
+ * so it needs only target_x[] and target_y[] and blur() keeps its row kernels
+ * for it. The other maps are full 2D: an int16 displacement per pixel, from
+ * the pixel to its source, clamped so the source's neighbours are onscreen.
+ *
+ * A frame's worth of displacements takes too long to build between two
+ * frames at large sizes, so a map asked for is built a slice of rows a frame
+ * into a spare map while the current one stays in use, and switched to when
+ * it is done. Asking for another map is only a compare, so the simulation can
+ * pick a new one as cheaply as it picks an effect.
+ *
+ * 2D maps are host only: one doesn't fit in a 64K segment on DOS, which always
+ * zooms.
+ */
+
+enum FeedbackKind {
+  kFeedbackZoom,     // the separable zoom towards the middle
+  kFeedbackRotate,   // zoom with a turn
+  kFeedbackSwirl,    // turns faster towards the middle
+  kFeedbackTunnel,   // pulls harder towards the edges
+  kFeedbackBallZoom, // zoom towards wherever the ball was
+  kNumFeedbackKinds,
+};
+
+#ifdef PP_HOST
+#define NUM_FEEDBACKS kNumFeedbackKinds // that the game picks from
+#else
+#define NUM_FEEDBACKS 1
+#endif
+
+#define FEEDBACK_BUILD_FRAMES 8 // a new map is ready this many frames later
+#define FEEDBACK_TILE_WIDTH 64  // columns blurred at a time within a band
+
+struct Displacement {
+  std::int16_t dx;
+  std::int16_t dy;
+};
+
+// The sources a row of a tile reads, not counting their neighbours
+struct TileSources {
+  short first_x;
+  short last_x;
+  short first_y;
+  short last_y;
+};
+
+struct FeedbackMap {
+  int kind;
+  int center_x;
+  int center_y;
+  int rows_built;
+
+  Displacement *offsets; // SCREEN_SIZE of them
+
+  // The source rows each row reads, so blur() can skip rows that are clear
+  short *first_rows;
+  short *last_rows;
+
+  // Each band's tiles in the order of where their sources are, so one tile's
+  // source is near the last one's
+  unsigned short *tile_order;
+  TileSources *tile_sources; // each row's tiles, left to right
+};
+
+struct Feedback {
+  FeedbackMap maps[2];
+  FeedbackMap *active;   // NULL for the separable zoom
+  FeedbackMap *building; // NULL unless a map is on its way
+  int kind;              // the last asked for
+  int center_x;
+  int center_y;
+};
+
+extern char const *const feedback_names[kNumFeedbackKinds];
+
+// The maps' memory is only allocated once a 2D map is asked for
+void init_feedback(Feedback &feedback);
+void free_feedback(Feedback &feedback);
+
+// Asks for the map of kind centred on (x, y), which only kFeedbackBallZoom
+// uses. The zoom takes effect at once, other maps once step_feedback() has
+// built them.
+void request_feedback(Feedback &feedback, int const kind, int const x,
+                      int const y);
+
+// Builds the next slice of the map asked for, on the worker pool, and switches
+// to it once it is done. Call once a frame.
+void step_feedback(Feedback &feedback);
+
+// The map to blur() with, NULL for the separable zoom
+inline FeedbackMap const *feedback_map(Feedback const &feedback) {
+  return feedback.active;
+}
+
+// Maps used on their own, without a Feedback. Host only. A map's memory is
+// allocated the first time it is built and reused after that.
+void init_feedback_map(FeedbackMap &map);
+void build_feedback_map(FeedbackMap &map, int const kind, int const x,
+                        int const y);
+void free_feedback_map(FeedbackMap &map);
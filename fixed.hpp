@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * 16.16 fixed point for the simulation.
+ *
+ * Everything that decides where the ball goes is integer math, so a session
+ * plays out the same on any CPU and compiler and a log recorded on one machine
+ * replays exactly on another. Products are built from unsigned 32-bit pieces,
+ * since a 16-bit DOS compiler has no fast 64-bit multiply and signed shifts
+ * and divisions of negative numbers aren't portable in C++98. Results round
+ * towards zero, like the float-to-int conversions they replace.
+ */
+
+typedef std::int32_t Fixed;
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (static_cast<Fixed>(1) << FIXED_SHIFT)
+
+inline Fixed int_to_fixed(int const value) {
+  return static_cast<Fixed>(value) * FIXED_ONE;
+}
+
+inline std::uint32_t fixed_magnitude(Fixed const value) {
+  return value < 0 ? 0u - static_cast<std::uint32_t>(value)
+                   : static_cast<std::uint32_t>(value);
+}
+
+inline Fixed apply_sign(std::uint32_t const magnitude, bool const is_negative) {
+  return is_negative ? -static_cast<Fixed>(magnitude)
+                     : static_cast<Fixed>(magnitude);
+}
+
+inline int fixed_to_int(Fixed const value) {
+  return static_cast<int>(
+      apply_sign(fixed_magnitude(value) >> FIXED_SHIFT, value < 0));
+}
+
+inline Fixed fixed_mul(Fixed const a, Fixed const b) {
+  std::uint32_t const x = fixed_magnitude(a);
+  std::uint32_t const y = fixed_magnitude(b);
+  std::uint32_t const x_hi = x >> 16, x_lo = x & 0xFFFF;
+  std::uint32_t const y_hi = y >> 16, y_lo = y & 0xFFFF;
+
+  std::uint32_t const product = ((x_hi * y_hi) << 16) + x_hi * y_lo +
+                                x_lo * y_hi + ((x_lo * y_lo) >> 16);
+  return apply_sign(product, (a < 0) != (b < 0));
+}
+
+inline Fixed fixed_div_int(Fixed const a, int const divisor) {
+  std::uint32_t const quotient =
+      fixed_magnitude(a) / fixed_magnitude(static_cast<Fixed>(divisor));
+  return apply_sign(quotient, (a < 0) != (divisor < 0));
+}
@@ -0,0 +1,366 @@
+#include "game.hpp"
+
+#include <cassert>
+
+#include "assets.hpp"
+#include "blur.hpp"
+#include "pacing.hpp"
+#include "profile.hpp"
+#include "tables.hpp"
+
+using std::uint8_t;
+
+/*
+ * Background effects
+ */
+
+inline EffectFunc choose_effect(Rnd &rnd) {
+  PROFILE_COUNT(kCountEffectChoices);
+  return effects[get_rnd(rnd) % NUM_EFFECTS];
+}
+
+int effect_index(EffectFunc const effect) {
+  int i = 0;
+  while (i < NUM_EFFECTS - 1 && effects[i] != effect) {
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Gameplay
+ */
+
+static void choose_palette(GameData &g) {
+  g.palette = get_rnd(g.rnd) % num_palettes;
+  g.is_noisy = palette_defs[g.palette].is_noisy != 0;
+}
+
+static void choose_feedback(GameData &g) {
+  g.feedback = get_rnd(g.feedback_rnd) % g.num_feedbacks;
+  g.feedback_x = fixed_to_int(g.ball_x);
+  g.feedback_y = fixed_to_int(g.ball_y);
+}
+
+static void enter_play(GameData &g, MouseState const &) {
+  init_rnd(g.rnd, g.seed, kRndRound);
+  init_rnd(g.feedback_rnd, g.seed, kRndFeedback);
+  choose_palette(g);
+
+  g.ball_x = int_to_fixed(MID_X);
+  g.ball_y = int_to_fixed(MID_Y);
+  g.prev_ball_x = g.ball_x;
+  g.prev_ball_y = g.ball_y;
+  g.ball_dx = (get_rnd(g.rnd) % 2) ? DIAG_START_SPEED : -DIAG_START_SPEED;
+  g.ball_dy = (get_rnd(g.rnd) % 2) ? DIAG_START_SPEED : -DIAG_START_SPEED;
+  g.speed = START_SPEED;
+  g.curr_effect = choose_effect(g.rnd);
+  g.score = 0;
+  g.feedback = kFeedbackZoom;
+  g.feedback_x = MID_X;
+  g.feedback_y = MID_Y;
+
+  // A stream of its own, so the particle count doesn't move the round's
+  Rnd nebula_rnd;
+  init_rnd(nebula_rnd, g.seed, kRndNebula);
+  reset_particles(g.nebula, g.seed);
+  for (int i = 0; i < g.nebula.num_orbiting; i++) {
+    // in quarter pixels
+    g.nebula.radius[i] = static_cast<std::int16_t>(
+        (get_rnd(nebula_rnd) % 4 + 5) * SCREEN_SCALE * 4);
+    g.nebula.growth[i] = 0;
+    g.nebula.phase[i] = static_cast<uint8_t>(get_rnd(nebula_rnd) % NUM_ANGLES);
+    // Take advantage of uint underflow to create complementary angles
+    g.nebula.sweep[i] = static_cast<uint8_t>(get_rnd(nebula_rnd) % 30 - 15);
+  }
+}
+
+enum Direction {
+  kForward = 1,
+  kReverse = -1,
+};
+
+static void process_hit(GameData &g, Fixed &front_delta, Fixed &front_pos,
+                        int const paddle_pos, Fixed &side_delta,
+                        Fixed const side_pos, int const mouse_pos,
+                        Direction const direction) {
+  PROFILE_COUNT(kCountPaddleHits);
+
+  // TODO: use the speed as an actual magnitude
+  g.speed += SPEED_INCREMENT;
+  front_delta = direction == kForward ? g.speed : -g.speed;
+  front_pos = int_to_fixed(paddle_pos) * 2 - front_pos;
+  side_delta = fixed_div_int(
+      fixed_mul(g.speed, side_pos - int_to_fixed(mouse_pos)),
+      SIDE_SPEED_DIVISOR * SCREEN_SCALE);
+  choose_palette(g);
+  g.curr_effect = choose_effect(g.rnd);
+  choose_feedback(g);
+  g.score++;
+  emit_burst(g.nebula, NEBULA_BURST);
+}
+
+typedef void (*EnterFn)(GameData &g, MouseState const &mouse);
+typedef State (*UpdateFn)(GameData &g, MouseState const &mouse);
+typedef void (*RenderFn)(GameView &view, DrawList &list, GameData const &g,
+                         MouseState const &mouse);
+
+struct StateEntry {
+  EnterFn enter;
+  UpdateFn update;
+  RenderFn render_back;
+  RenderFn render_front;
+};
+
+inline void apply_deltas(GameData &g) {
+  g.prev_ball_x = g.ball_x;
+  g.prev_ball_y = g.ball_y;
+  g.ball_x += g.ball_dx;
+  g.ball_y += g.ball_dy;
+  update_particles(g.nebula);
+}
+
+static State update_play(GameData &g, MouseState const &mouse) {
+  apply_deltas(g);
+
+  Fixed const near_edge = int_to_fixed(PADDLE_MARGIN_HIT);
+  Fixed const right_edge = int_to_fixed(SCREEN_WIDTH - PADDLE_MARGIN_HIT);
+  Fixed const bottom_edge = int_to_fixed(SCREEN_HEIGHT - PADDLE_MARGIN_HIT);
+
+  bool is_out = false;
+
+  if (g.ball_x >= right_edge || g.ball_x < near_edge ||
+      g.ball_y >= bottom_edge || g.ball_y < near_edge) {
+
+    is_out = true;
+
+    if (g.ball_x < near_edge &&
+        g.ball_y > int_to_fixed(mouse.y - HALF_PADDLE_HIT) &&
+        g.ball_y < int_to_fixed(mouse.y + HALF_PADDLE_HIT)) {
+      // Left paddle hit
+      process_hit(g, g.ball_dx, g.ball_x, PADDLE_MARGIN_HIT, g.ball_dy,
+                  g.ball_y, mouse.y, kForward);
+      is_out = false;
+    } else if (g.ball_x > right_edge &&
+               g.ball_y < int_to_fixed(MAX_Y - (mouse.y - HALF_PADDLE_HIT)) &&
+               g.ball_y > int_to_fixed(MAX_Y - (mouse.y + HALF_PADDLE_HIT))) {
+      // Right paddle hit
+      process_hit(g, g.ball_dx, g.ball_x, SCREEN_WIDTH - PADDLE_MARGIN_HIT,
+                  g.ball_dy, g.ball_y, MAX_Y - mouse.y, kReverse);
+      is_out = false;
+    } else if (g.ball_y < near_edge &&
+               g.ball_x < int_to_fixed(MAX_X - (mouse.x - HALF_PADDLE_HIT)) &&
+               g.ball_x > int_to_fixed(MAX_X - (mouse.x + HALF_PADDLE_HIT))) {
+      // top paddle hit
+      process_hit(g, g.ball_dy, g.ball_y, PADDLE_MARGIN_HIT, g.ball_dx,
+                  g.ball_x, MAX_X - mouse.x, kForward);
+      is_out = false;
+    } else if (g.ball_y > bottom_edge &&
+               g.ball_x > int_to_fixed(mouse.x - HALF_PADDLE_HIT) &&
+               g.ball_x < int_to_fixed(mouse.x + HALF_PADDLE_HIT)) {
+      // bottom paddle hit
+      process_hit(g, g.ball_dy, g.ball_y, SCREEN_HEIGHT - PADDLE_MARGIN_HIT,
+                  g.ball_dx, g.ball_x, mouse.x, kReverse);
+      is_out = false;
+    }
+  }
+
+  return is_out ? kLosing : kPlaying;
+}
+
+static void render_play_back(GameView &view, DrawList &list, GameData const &g,
+                             MouseState const &) {
+  g.curr_effect(list, view.effect_rnd);
+}
+
+inline int nucleus_jitter(Rnd &rnd) {
+  return (get_rnd(rnd) % NUCLEUS_JITTER - (NUCLEUS_JITTER >> 1)) *
+         SCREEN_SCALE;
+}
+
+// Between the previous tick's value and the current one, by blend
+inline Fixed blended(Fixed const previous, Fixed const current,
+                     int const blend) {
+  std::uint32_t const distance = fixed_magnitude(current - previous);
+  std::uint32_t const part = (distance >> BLEND_SHIFT) * blend +
+                             (((distance & (BLEND_ONE - 1)) * blend) >>
+                              BLEND_SHIFT);
+  return previous + apply_sign(part, current < previous);
+}
+
+static void render_play_front(GameView &view, DrawList &list, GameData const &g,
+                              MouseState const &mouse) {
+  Fixed const ball_x = blended(g.prev_ball_x, g.ball_x, g.blend);
+  Fixed const ball_y = blended(g.prev_ball_y, g.ball_y, g.blend);
+
+  record_number(list, SCORE_X, SCORE_Y, g.score, view.score_text);
+
+  // draw paddles
+  Segment const paddles[] = {
+      // TOP
+      {MAX_X - (mouse.x - HALF_PADDLE), PADDLE_MARGIN,
+       MAX_X - (mouse.x + HALF_PADDLE), PADDLE_MARGIN},
+      // BOTTOM
+      {mouse.x - HALF_PADDLE, SCREEN_HEIGHT - PADDLE_MARGIN,
+       mouse.x + HALF_PADDLE, SCREEN_HEIGHT - PADDLE_MARGIN},
+      // LEFT
+      {PADDLE_MARGIN, mouse.y - HALF_PADDLE, PADDLE_MARGIN,
+       mouse.y + HALF_PADDLE},
+      // RIGHT
+      {SCREEN_WIDTH - PADDLE_MARGIN, MAX_Y - (mouse.y - HALF_PADDLE),
+       SCREEN_WIDTH - PADDLE_MARGIN, MAX_Y - (mouse.y + HALF_PADDLE)},
+  };
+  record_lines(list, paddles, sizeof(paddles) / sizeof(Segment), MAX_COLOR);
+
+  // Draw "nucleus"
+  Segment nucleus[NUCLEUS_LINES];
+  for (int i = 0; i < NUCLEUS_LINES; i++) {
+    // Filled last field first, the order GCC evaluated these in when they
+    // were line()'s arguments, so recorded sessions still replay the same
+    Segment &segment = nucleus[i];
+    segment.y2 = fixed_to_int(ball_y) + nucleus_jitter(view.nucleus_rnd);
+    segment.x2 = fixed_to_int(ball_x) + nucleus_jitter(view.nucleus_rnd);
+    segment.y1 = fixed_to_int(ball_y) + nucleus_jitter(view.nucleus_rnd);
+    segment.x1 = fixed_to_int(ball_x) + nucleus_jitter(view.nucleus_rnd);
+  }
+  record_lines(list, nucleus, NUCLEUS_LINES, 230);
+
+  // Draw nebula
+  plot_particles(g.nebula, ball_x, ball_y, view.nebula_points);
+  record_points(list, view.nebula_points, MAX_COLOR);
+}
+
+static State update_losing(GameData &g, MouseState const &) {
+  apply_deltas(g);
+
+  if (g.ball_x < int_to_fixed(-LOST_MARGIN) ||
+      g.ball_x > int_to_fixed(MAX_X + LOST_MARGIN) ||
+      g.ball_y < int_to_fixed(-LOST_MARGIN) ||
+      g.ball_y > int_to_fixed(MAX_Y + LOST_MARGIN)) {
+    return kLost;
+  }
+
+  return kLosing;
+}
+
+static void enter_lost(GameData &g, MouseState const &) {
+  g.countdown = COUNTDOWN_FRAMES;
+}
+
+static State update_lost(GameData &g, MouseState const &) {
+  g.countdown--;
+  if (g.countdown == 0) {
+    g.score--;
+    g.countdown = COUNTDOWN_FRAMES;
+  }
+
+  if (g.score < 0) {
+    return kPlaying;
+  }
+
+  return kLost;
+}
+
+static void render_lost(GameView &view, DrawList &list, GameData const &g,
+                        MouseState const &) {
+  record_number(list, COUNTDOWN_X, COUNTDOWN_Y, g.score, view.score_text);
+}
+
+static const StateEntry state_table[kNumStates] = {
+    {enter_play, update_play, render_play_back, render_play_front}, // kPlaying
+    {NULL, update_losing, render_play_back, render_play_front},     // kLosing
+    {enter_lost, update_lost, NULL, render_lost},                   // kLost
+};
+
+// Orbiting particles and room for the bursts
+#define MAX_BURST_PARTICLES (NEBULA_BURST * NEBULA_BURSTS)
+
+void init_game(Game &game, int const num_particles) {
+  init_particles(game.g.nebula, num_particles, MAX_BURST_PARTICLES);
+}
+
+void free_game(Game &game) { free_particles(game.g.nebula); }
+
+void start_game(Game &game, std::uint32_t const seed,
+                int const num_feedbacks) {
+  MouseState const mouse = {MID_X, MID_Y, 0};
+  game.g.seed = seed;
+  game.g.num_feedbacks = num_feedbacks;
+  game.g.blend = BLEND_ONE;
+  game.state = kPlaying;
+  enter_play(game.g, mouse);
+}
+
+void copy_game(Game &dest, Game const &game) {
+  ParticlePool const nebula = dest.g.nebula;
+  dest = game;
+  dest.g.nebula = nebula;
+  copy_particles(dest.g.nebula, game.g.nebula);
+}
+
+void run_tick(Game &game, MouseState const &mouse) {
+  PROFILE_SCOPE(kPhaseUpdate);
+  State const new_state = state_table[game.state].update(game.g, mouse);
+
+  if (new_state != game.state) {
+    game.state = new_state;
+
+    if (state_table[game.state].enter) {
+      state_table[game.state].enter(game.g, mouse);
+    }
+  }
+}
+
+/*
+ * Rendering
+ */
+
+long view_arena_size(int const num_particles) {
+  return point_set_arena_size(num_particles + MAX_BURST_PARTICLES) +
+         2 * draw_list_arena_size();
+}
+
+void init_view(GameView &view, int const num_particles,
+               std::uint32_t const seed) {
+  init_rnd(view.effect_rnd, seed, kRndEffect);
+  init_rnd(view.nucleus_rnd, seed, kRndNucleus);
+  init_rnd(view.dither_rnd, seed, kRndDither);
+  init_point_set(view.nebula_points, num_particles + MAX_BURST_PARTICLES);
+  init_feedback(view.feedback);
+  init_draw_list(view.back_list);
+  init_draw_list(view.front_list);
+}
+
+void free_view(GameView &view) { free_feedback(view.feedback); }
+
+void render_game(GameView &view, Game const &game, MouseState const &mouse,
+                 uint8_t *const front_buffer, uint8_t *const back_buffer) {
+  GameData const &g = game.g;
+  StateEntry const &entry = state_table[game.state];
+
+  if (entry.render_back) {
+    PROFILE_SCOPE(kPhaseRenderBack);
+    clear_draw_list(view.back_list);
+    entry.render_back(view, view.back_list, g, mouse);
+    draw_list(view.back_list, back_buffer);
+  }
+
+  std::uint32_t const seed = g.is_noisy ? next_rnd32(view.dither_rnd) : 0;
+  {
+    // Only recorded here; it is drawn during blur()
+    PROFILE_SCOPE(kPhaseRenderFront);
+    clear_draw_list(view.front_list);
+    entry.render_front(view, view.front_list, g, mouse);
+    bin_draw_list(view.front_list);
+  }
+
+  PROFILE_SCOPE(kPhaseBlur);
+  request_feedback(view.feedback, g.feedback, g.feedback_x, g.feedback_y);
+  step_feedback(view.feedback);
+  FeedbackMap const *const map = feedback_map(view.feedback);
+  if (g.is_noisy) {
+    blur<true>(front_buffer, back_buffer, seed, view.front_list, map);
+  } else {
+    blur<false>(front_buffer, back_buffer, seed, view.front_list, map);
+  }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+
+#include "drawing.hpp"
+#include "drawlist.hpp"
+#include "effects.hpp"
+#include "feedback.hpp"
+#include "fixed.hpp"
+#include "particle.hpp"
+#include "rnd.hpp"
+#include "system.hpp"
+
+/*
+ * The game
+ *
+ * Everything a game needs lives in its Game and, if it is drawn, its GameView,
+ * so any number of them can run side by side, one per thread. The look-up
+ * tables, the zoom tables and the assets are shared but only read.
+ */
+
+/*
+ * Configuration constants
+ *
+ * These will likely become settings/config files, command line args, etc.
+ * Sizes and speeds are for 320x200 and grow with SCREEN_SCALE.
+ */
+
+// Gameplay, in 16.16 fixed point so every compiler gets the same values
+#define START_SPEED (117965L * SCREEN_SCALE)     // 1.8
+#define DIAG_START_SPEED (83414L * SCREEN_SCALE) // START_SPEED / sqrt(2)
+#define SPEED_INCREMENT (3277L * SCREEN_SCALE)   // .05
+#define SIDE_SPEED_DIVISOR 8
+
+#define COLLISION_THRESHOLD 15
+
+#define PADDLE_MARGIN_HIT (13 * SCREEN_SCALE)
+#define HALF_PADDLE_HIT (18 * SCREEN_SCALE)
+
+#define LOST_MARGIN (18 * SCREEN_SCALE) // how far offscreen the ball goes
+
+#define QUIT (LMB + RMB)
+
+// Graphics
+#define SCORE_X 10
+#define SCORE_Y 10
+
+#define COUNTDOWN_X (MID_X - 6)
+#define COUNTDOWN_Y (MID_Y - 7)
+#define COUNTDOWN_FRAMES 4
+
+#define PADDLE_MARGIN (10 * SCREEN_SCALE)
+#define HALF_PADDLE (16 * SCREEN_SCALE)
+
+#define NEBULA_PARTICLES 25 // orbiting ones, unless --particles says
+#define NEBULA_BURST 48      // emitted on each hit
+#define NEBULA_BURSTS 4      // that can be alive at once
+#define NUCLEUS_JITTER 6
+#define NUCLEUS_LINES 5
+
+/*
+ * Defined constants
+ *
+ * Changing these values would require code changes, name changes, or
+ * tearing apart the fabric of reality.
+ */
+
+#define MOUSE_MARGIN ((PADDLE_MARGIN) + (HALF_PADDLE))
+#define MOUSE_X_RANGE ((SCREEN_WIDTH)-2 * (MOUSE_MARGIN))
+#define MOUSE_Y_RANGE ((SCREEN_HEIGHT)-2 * (MOUSE_MARGIN))
+
+struct GameData {
+  Fixed ball_x;
+  Fixed ball_y;
+  Fixed ball_dx;
+  Fixed ball_dy;
+  Fixed speed;
+
+  // Where the ball was a tick ago, and how far from there towards ball_x and
+  // ball_y to draw it, out of BLEND_ONE
+  Fixed prev_ball_x;
+  Fixed prev_ball_y;
+  int blend;
+
+  std::uint32_t seed; // every round starts its streams from here
+  Rnd rnd;            // the kRndRound stream
+
+  EffectFunc curr_effect;
+  int score;
+  int countdown;
+
+  // Index into palette_bank. The main loop uploads it with the next frame.
+  int palette;
+  bool is_noisy;
+
+  // The FeedbackKind the renderer is asked for, one of the first
+  // num_feedbacks, and where the ball was when it was picked
+  int feedback;
+  int feedback_x;
+  int feedback_y;
+  int num_feedbacks;
+  Rnd feedback_rnd; // the kRndFeedback stream
+
+  ParticlePool nebula;
+};
+
+enum State {
+  kPlaying = 0,
+  kLosing,
+  kLost,
+  kNumStates,
+};
+
+struct Game {
+  GameData g;
+  State state;
+};
+
+// The render hooks' own state, so drawing a frame never moves the simulation's
+struct GameView {
+  Rnd effect_rnd;
+  Rnd nucleus_rnd;
+  Rnd dither_rnd;
+
+  // The score and the countdown show the same number, so they share a run
+  TextRun score_text;
+
+  // Where the nebula was plotted this frame
+  PointSet nebula_points;
+
+  Feedback feedback;
+
+  DrawList back_list;
+  DrawList front_list;
+};
+
+// Allocates the nebula, with num_particles orbiting the ball. A game isn't
+// ready to run until start_game().
+void init_game(Game &game, int const num_particles);
+void free_game(Game &game);
+
+// Starts the first round. Hits pick from the first num_feedbacks feedback
+// maps, at most NUM_FEEDBACKS.
+void start_game(Game &game, std::uint32_t const seed,
+                int const num_feedbacks);
+
+// Copies game into dest, whose nebula has storage of its own
+void copy_game(Game &dest, Game const &game);
+
+// Runs one tick of the current state, and enters the next state if it changes
+void run_tick(Game &game, MouseState const &mouse);
+
+// The index of g.curr_effect in effects[]
+int effect_index(EffectFunc const effect);
+
+// What init_view() takes from the frame arena
+long view_arena_size(int const num_particles);
+
+// Sets up a view of a game of num_particles, taking its draw lists from the
+// frame arena: call it from one thread at a time. The arena keeps them until
+// it stops.
+void init_view(GameView &view, int const num_particles,
+               std::uint32_t const seed);
+void free_view(GameView &view);
+
+// Draws the next frame of game into front_buffer, from the last one in
+// back_buffer. The caller swaps them afterwards.
+void render_game(GameView &view, Game const &game, MouseState const &mouse,
+                 std::uint8_t *const front_buffer,
+                 std::uint8_t *const back_buffer);
@@ -0,0 +1,56 @@
+/*
+ * Writes tables.cpp to stdout. Host tool, not part of the game.
+ *
+ *   g++ -Ihost -o gentabs gentabs.cpp && ./gentabs > tables.cpp
+ */
+
+#include <cstdio>
+
+#include "tables.hpp"
+
+static void begin_table(char const *const declaration) {
+  std::printf("\n%s = {", declaration);
+}
+
+static void end_table() { std::printf("\n};\n"); }
+
+static void item(int const i, int const per_line, char const *const format,
+                 double const value) {
+  std::printf(i % per_line ? " " : "\n  ");
+  std::printf(format, value);
+  std::printf(",");
+}
+
+int main() {
+  std::printf("// Generated by gentabs.cpp from the *_entry() functions in "
+              "tables.hpp.\n// Do not edit.\n\n#include \"tables.hpp\"\n");
+  std::printf("\n// clang-format off\n");
+
+  begin_table("SinCos const sincos_table[NUM_ANGLES]");
+  for (int i = 0; i < NUM_ANGLES; i++) {
+    std::printf(i % 4 ? " " : "\n  ");
+    std::printf("{%d, %d},", cos_entry(i), sin_entry(i));
+  }
+  end_table();
+
+  begin_table("PixelOffset const vga_target_x[VGA_WIDTH]");
+  for (int i = 0; i < VGA_WIDTH; i++) {
+    item(i, 12, "%.0f", target_x_entry(i, VGA_WIDTH));
+  }
+  end_table();
+
+  begin_table("PixelOffset const vga_target_y[VGA_HEIGHT]");
+  for (int i = 0; i < VGA_HEIGHT; i++) {
+    item(i, 10, "%.0f", target_y_entry(i, VGA_WIDTH, VGA_HEIGHT));
+  }
+  end_table();
+
+  begin_table("std::uint8_t const weighted_averages[NUM_WEIGHTED_SUMS]");
+  for (int i = 0; i < NUM_WEIGHTED_SUMS; i++) {
+    item(i, 16, "%.0f", weighted_average_entry(i));
+  }
+  end_table();
+
+  std::printf("// clang-format on\n");
+  return 0;
+}
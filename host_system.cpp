@@ -0,0 +1,323 @@
+/*
+ * Headless backend for modern hosts.
+ *
+ * Video memory and the DAC are emulated in memory and the mouse is driven by a
+ * script, so the game loop can be run and measured without DOS. Options:
+ *
+ *   --frames N      run N frames paced at the VGA refresh rate
+ *   --bench N       run N frames without waiting for retrace, print timings
+ *   --mouse FILE    read mouse input from FILE (lines of "frames x y buttons")
+ *   --dump FILE     write the last presented frame to FILE as a binary PPM
+ *   --size WxH      framebuffer size, from 320x200 up to 3840x2160
+ *   --capture FILE  record the presented frames to FILE as an FLC animation
+ *   --present MODE  "changes" (the default) sends only the changed blocks of
+ *                   each frame to video memory, "full" copies all of it
+ */
+
+#include "system.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "capture.hpp"
+#include "present.hpp"
+
+using std::uint8_t;
+
+#define DEFAULT_FRAMES (REFRESH_RATE * 10)
+
+#define MOUSE_SWEEP_X 7 // pixels per frame of the built-in mouse sweep
+#define MOUSE_SWEEP_Y 3
+
+typedef std::chrono::steady_clock Clock;
+
+struct MouseStep {
+  long frames;
+  MouseState state;
+};
+
+Resolution g_resolution = {VGA_WIDTH, VGA_HEIGHT, 1};
+
+static std::vector<uint8_t> g_vram_storage;
+static uint8_t *g_vram; // last presented frame, possibly a capture frame
+static uint8_t g_dac[NUM_COLORS][3];
+static bool g_is_dac_changed = true;
+
+static long g_max_frames = DEFAULT_FRAMES;
+static long g_frame = 0;
+static bool g_is_bench = false;
+static char const *g_dump_path = NULL;
+static char const *g_capture_path = NULL;
+static bool g_is_full_present = false;
+static double g_bytes_sent = 0;
+
+static std::vector<MouseStep> g_script;
+static std::size_t g_script_step = 0;
+static long g_step_frame = 0;
+
+static Clock::time_point g_start;
+static Clock::time_point g_next_retrace;
+
+static bool parse_count(char const *arg, long &count) {
+  char *end;
+  count = std::strtol(arg, &end, 10);
+  return *arg != '\0' && *end == '\0' && count > 0;
+}
+
+static bool load_script(char const *path) {
+  std::FILE *const file = std::fopen(path, "r");
+  if (!file) {
+    std::cerr << "Unable to open mouse script " << path << "\n";
+    return false;
+  }
+
+  MouseStep step;
+  while (std::fscanf(file, "%ld %d %d %d", &step.frames, &step.state.x,
+                     &step.state.y, &step.state.buttons) == 4) {
+    g_script.push_back(step);
+  }
+
+  std::fclose(file);
+
+  if (g_script.empty()) {
+    std::cerr << "Mouse script " << path << " has no steps\n";
+    return false;
+  }
+  return true;
+}
+
+static bool parse_size(char const *arg) {
+  int width, height;
+  char extra;
+  if (std::sscanf(arg, "%dx%d%c", &width, &height, &extra) != 2 ||
+      width < VGA_WIDTH || width > MAX_SCREEN_WIDTH || height < VGA_HEIGHT ||
+      height > MAX_SCREEN_HEIGHT) {
+    std::cerr << "Size must be between " << VGA_WIDTH << "x" << VGA_HEIGHT
+              << " and " << MAX_SCREEN_WIDTH << "x" << MAX_SCREEN_HEIGHT
+              << "\n";
+    return false;
+  }
+
+  g_resolution.width = width;
+  g_resolution.height = height;
+  g_resolution.scale = std::min(width / VGA_WIDTH, height / VGA_HEIGHT);
+  return true;
+}
+
+bool init_system(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    bool const has_value = i + 1 < argc;
+
+    if (!std::strcmp(argv[i], "--frames") && has_value) {
+      if (!parse_count(argv[++i], g_max_frames))
+        return false;
+      g_is_bench = false;
+    } else if (!std::strcmp(argv[i], "--bench") && has_value) {
+      if (!parse_count(argv[++i], g_max_frames))
+        return false;
+      g_is_bench = true;
+    } else if (!std::strcmp(argv[i], "--mouse") && has_value) {
+      if (!load_script(argv[++i]))
+        return false;
+    } else if (!std::strcmp(argv[i], "--dump") && has_value) {
+      g_dump_path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--capture") && has_value) {
+      g_capture_path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--size") && has_value) {
+      if (!parse_size(argv[++i]))
+        return false;
+    } else if (!std::strcmp(argv[i], "--present") && has_value &&
+               (!std::strcmp(argv[i + 1], "full") ||
+                !std::strcmp(argv[i + 1], "changes"))) {
+      g_is_full_present = !std::strcmp(argv[++i], "full");
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--frames N | --bench N] [--mouse FILE] [--dump FILE]"
+                   " [--size WxH] [--capture FILE]"
+                   " [--present full|changes]\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool set_vga_mode() {
+  g_vram_storage.assign(SCREEN_SIZE, 0);
+  g_vram = &g_vram_storage[0];
+
+  if (g_capture_path && !start_capture(g_capture_path, SCREEN_WIDTH,
+                                       SCREEN_HEIGHT, 1000 / REFRESH_RATE)) {
+    return false;
+  }
+  g_start = Clock::now();
+  g_next_retrace = g_start;
+  return true;
+}
+
+static std::uint32_t checksum(uint8_t const *data, std::size_t size) {
+  // FNV-1a, enough to tell whether two runs produced the same frame
+  std::uint32_t hash = 2166136261u;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static void dump_frame(char const *path) {
+  std::FILE *const file = std::fopen(path, "wb");
+  if (!file) {
+    std::cerr << "Unable to write " << path << "\n";
+    return;
+  }
+
+  std::fprintf(file, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+  for (int i = 0; i < SCREEN_SIZE; ++i) {
+    uint8_t rgb[3];
+    for (int c = 0; c < 3; ++c) {
+      // Expand 6-bit DAC components to 8 bits
+      uint8_t const component = g_dac[g_vram[i]][c];
+      rgb[c] = static_cast<uint8_t>((component << 2) | (component >> 4));
+    }
+    std::fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  std::fclose(file);
+}
+
+void reset_mode() {
+  if (g_is_bench && g_frame > 0) {
+    double const ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - g_start)
+            .count();
+    std::printf("bench: %ld frames in %.3f s, %.1f frames/sec, %.0f ns/frame, "
+                "%.0f bytes/frame sent (%.1f%%), checksum %08lx\n",
+                g_frame, ns / 1e9, g_frame * 1e9 / ns, ns / g_frame,
+                g_bytes_sent / g_frame,
+                100 * g_bytes_sent / g_frame / SCREEN_SIZE,
+                static_cast<unsigned long>(checksum(g_vram, SCREEN_SIZE)));
+  }
+
+  if (g_dump_path) {
+    dump_frame(g_dump_path);
+  }
+
+  stop_capture();
+}
+
+std::uint32_t get_time_us() {
+  if (g_is_bench) {
+    // Exactly one retrace per frame, so benchmarks run one tick a frame and
+    // give the same checksum however fast the machine is
+    return static_cast<std::uint32_t>(g_frame * 1000000LL / REFRESH_RATE);
+  }
+  return static_cast<std::uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now().time_since_epoch())
+          .count());
+}
+
+void wait_until(std::uint32_t const time_us) {
+  std::int32_t const remaining =
+      static_cast<std::int32_t>(time_us - get_time_us());
+  if (remaining > 0 && !g_is_bench) {
+    std::this_thread::sleep_for(std::chrono::microseconds(remaining));
+  }
+}
+
+long show_buffer(uint8_t *const front_buffer, uint8_t const *const palette) {
+  if (!g_is_bench) {
+    // Stand-in for waiting on VRETRACE
+    g_next_retrace += std::chrono::microseconds(1000000 / REFRESH_RATE);
+    std::this_thread::sleep_until(g_next_retrace);
+  }
+
+  if (palette) {
+    set_palette_block(0, NUM_COLORS, palette);
+  }
+
+  long sent = SCREEN_SIZE;
+  bool const is_full = g_is_full_present || g_frame == 0;
+  if (g_capture_path) {
+    // Present straight into a capture frame so the writer can have it as is.
+    // The writer holds on to the last one until it has this one, so it still
+    // says what changed.
+    CaptureFrame &frame = acquire_capture_frame();
+    if (!is_full) {
+      sent = count_changes(g_vram, front_buffer, SCREEN_SIZE);
+    }
+    std::memcpy(&frame.pixels[0], front_buffer, SCREEN_SIZE);
+    std::memcpy(frame.palette, g_dac, sizeof(g_dac));
+    frame.is_palette_changed = g_is_dac_changed;
+    g_is_dac_changed = false;
+    submit_capture_frame(frame);
+    g_vram = &frame.pixels[0];
+  } else if (is_full) {
+    std::memcpy(g_vram, front_buffer, SCREEN_SIZE);
+  } else {
+    // Emulated video memory is as quick to read as the shadow would be
+    sent = present_changes(g_vram, g_vram, front_buffer, SCREEN_SIZE);
+  }
+  g_bytes_sent += sent;
+  ++g_frame;
+  return sent;
+}
+
+void set_pal_entry(uint8_t const index, uint8_t const red, uint8_t const green,
+                   uint8_t const blue) {
+  g_dac[index][0] = red;
+  g_dac[index][1] = green;
+  g_dac[index][2] = blue;
+  g_is_dac_changed = true;
+}
+
+void set_palette_block(uint8_t const first, int const count,
+                       uint8_t const *const rgb) {
+  std::memcpy(g_dac[first], rgb, count * 3);
+  g_is_dac_changed = true;
+}
+
+bool has_mouse() { return true; }
+
+static int triangle(long const t, int const range) {
+  long const period = 2L * (range - 1);
+  long const phase = t % period;
+  return static_cast<int>(phase < range ? phase : period - phase);
+}
+
+void get_mouse_state(MouseState &mouse) {
+  if (g_frame == 0) {
+    // Time the loop itself, not the table setup in init()
+    g_start = Clock::now();
+    g_next_retrace = g_start;
+  }
+
+  if (g_frame >= g_max_frames) {
+    mouse.buttons = LMB | RMB;
+    return;
+  }
+
+  if (g_script.empty()) {
+    mouse.x = triangle(g_frame * MOUSE_SWEEP_X, SCREEN_WIDTH);
+    mouse.y = triangle(g_frame * MOUSE_SWEEP_Y, SCREEN_HEIGHT);
+    mouse.buttons = 0;
+    return;
+  }
+
+  if (g_script_step >= g_script.size()) {
+    mouse.buttons = LMB | RMB;
+    return;
+  }
+
+  mouse = g_script[g_script_step].state;
+  mouse.x = std::max(0, std::min(mouse.x, SCREEN_WIDTH - 1));
+  mouse.y = std::max(0, std::min(mouse.y, SCREEN_HEIGHT - 1));
+  if (++g_step_frame >= g_script[g_script_step].frames) {
+    ++g_script_step;
+    g_step_frame = 0;
+  }
+}
@@ -0,0 +1,134 @@
+/*
+ * Writes an asset pack (see assets.hpp). Host tool, not part of the game.
+ *
+ *   g++ -Ihost -o mkpack mkpack.cpp assets.cpp palettes.cpp sprites.cpp
+ *   ./mkpack pp.dat [PALETTES]
+ *
+ * With no PALETTES file the pack holds the built-in palettes. Otherwise the
+ * palettes are read from the text file, so adding one only takes a new pack:
+ *
+ *   # comments run to the end of the line
+ *   palette noisy              (or "palette clean")
+ *   0 31    0 0 0    0 0 63    first and last index, first and last color
+ *   32 63   0 0 63   0 0 0     up to MAX_PALETTE_RANGES ranges per palette
+ *
+ * Colors are 6-bit DAC components, 0 to 63.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "assets.hpp"
+
+static bool parse_error(char const *const path, int const line_number,
+                        char const *const message) {
+  std::cerr << path << ":" << line_number << ": " << message << "\n";
+  return false;
+}
+
+static bool is_color(int const r, int const g, int const b) {
+  return r >= 0 && r <= MAX_COLOR_COMPONENT && g >= 0 &&
+         g <= MAX_COLOR_COMPONENT && b >= 0 && b <= MAX_COLOR_COMPONENT;
+}
+
+static bool read_palettes(char const *const path,
+                          std::vector<PaletteDef> &defs) {
+  std::FILE *const file = std::fopen(path, "r");
+  if (file == NULL) {
+    std::cerr << "Unable to open " << path << "\n";
+    return false;
+  }
+
+  bool is_ok = true;
+  char line[256];
+  for (int line_number = 1; is_ok && std::fgets(line, sizeof(line), file);
+       line_number++) {
+    if (char *const comment = std::strchr(line, '#')) {
+      *comment = '\0';
+    }
+
+    char kind[16];
+    int first, last, r0, g0, b0, r1, g1, b1;
+    if (std::sscanf(line, " palette %15s", kind) == 1) {
+      if (std::strcmp(kind, "noisy") && std::strcmp(kind, "clean")) {
+        is_ok = parse_error(path, line_number, "expected noisy or clean");
+        break;
+      }
+      PaletteDef def;
+      std::memset(&def, 0, sizeof(def));
+      def.is_noisy = !std::strcmp(kind, "noisy");
+      defs.push_back(def);
+    } else if (std::sscanf(line, "%d %d %d %d %d %d %d %d", &first, &last,
+                           &r0, &g0, &b0, &r1, &g1, &b1) == 8) {
+      if (defs.empty()) {
+        is_ok = parse_error(path, line_number, "range before any palette");
+      } else if (defs.back().num_ranges == MAX_PALETTE_RANGES) {
+        is_ok = parse_error(path, line_number, "too many ranges");
+      } else if (first < 0 || first >= last || last >= NUM_COLORS) {
+        is_ok = parse_error(path, line_number, "bad index range");
+      } else if (!is_color(r0, g0, b0) || !is_color(r1, g1, b1)) {
+        is_ok = parse_error(path, line_number, "bad color");
+      } else {
+        PaletteDef &def = defs.back();
+        PaletteRange &range = def.ranges[def.num_ranges++];
+        range.first_index = static_cast<std::uint8_t>(first);
+        range.last_index = static_cast<std::uint8_t>(last);
+        PaletteColor const first_color = {static_cast<std::uint8_t>(r0),
+                                          static_cast<std::uint8_t>(g0),
+                                          static_cast<std::uint8_t>(b0)};
+        PaletteColor const last_color = {static_cast<std::uint8_t>(r1),
+                                         static_cast<std::uint8_t>(g1),
+                                         static_cast<std::uint8_t>(b1)};
+        range.first_color = first_color;
+        range.last_color = last_color;
+      }
+    } else if (std::strspn(line, " \t\r\n") != std::strlen(line)) {
+      is_ok = parse_error(path, line_number, "expected a palette or a range");
+    }
+  }
+  std::fclose(file);
+
+  if (is_ok && defs.empty()) {
+    std::cerr << path << " has no palettes\n";
+    is_ok = false;
+  }
+  return is_ok;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " PACK [PALETTES]\n";
+    return 1;
+  }
+
+  std::vector<PaletteDef> defs;
+  if (argc == 3) {
+    if (!read_palettes(argv[2], defs))
+      return 1;
+  } else {
+    defs.assign(palettes, palettes + NUM_PALETTES);
+  }
+
+  long size;
+  std::uint8_t *const pack =
+      build_pack(&defs[0], static_cast<int>(defs.size()), size);
+  if (pack == NULL) {
+    std::cerr << "Too many palettes\n";
+    return 1;
+  }
+
+  std::FILE *const file = std::fopen(argv[1], "wb");
+  if (file == NULL ||
+      std::fwrite(pack, 1, size, file) != static_cast<std::size_t>(size) ||
+      std::fclose(file) != 0) {
+    std::cerr << "Unable to write " << argv[1] << "\n";
+    return 1;
+  }
+
+  std::cout << argv[1] << ": " << defs.size() << " palettes, " << size
+            << " bytes\n";
+  delete[] pack;
+  return 0;
+}
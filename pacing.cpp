@@ -0,0 +1,115 @@
+#include "pacing.hpp"
+
+#include <cmath>
+#include <iostream>
+
+#include "system.hpp"
+
+#define TICK_UNITS 1000000L // a tick in microseconds * TICK_RATE
+#define RETRACE_US (1000000L / REFRESH_RATE)
+
+void start_pacing(FramePacer &pacer) {
+  pacer.last_time = get_time_us();
+  // One tick behind, so the first frame runs the first tick
+  pacer.ahead = -TICK_UNITS;
+
+  pacer.last_present = pacer.last_time;
+  pacer.frames = 0;
+  pacer.ticks = 0;
+  pacer.dropped_ticks = 0;
+  pacer.missed = 0;
+  pacer.interval_sum = 0;
+  pacer.interval_sum_sq = 0;
+  pacer.worst_interval = 0;
+  pacer.latency_sum = 0;
+  pacer.worst_latency = 0;
+  pacer.queued_sum = 0;
+  pacer.worst_queued = 0;
+}
+
+FrameTiming pace_frame(FramePacer &pacer) {
+  std::uint32_t const now = get_time_us();
+  std::uint32_t elapsed = now - pacer.last_time;
+  pacer.last_time = now;
+
+  // Past the catch-up limit the time is dropped: the game slows down instead
+  // of spending ever longer catching up
+  long const limit = static_cast<long>(MAX_CATCHUP_TICKS) * TICK_UNITS;
+  long const behind = -pacer.ahead;
+  std::uint32_t const max_elapsed = (limit - behind) / TICK_RATE;
+  if (elapsed > max_elapsed) {
+    pacer.dropped_ticks += (elapsed - max_elapsed) / (TICK_UNITS / TICK_RATE);
+    elapsed = max_elapsed;
+  }
+  pacer.ahead -= static_cast<long>(elapsed) * TICK_RATE;
+
+  FrameTiming timing;
+  timing.ticks = 0;
+  while (pacer.ahead < 0) {
+    pacer.ahead += TICK_UNITS;
+    timing.ticks++;
+  }
+
+  // ahead is now in [0, TICK_UNITS): the present is that far before the
+  // latest tick
+  timing.blend = static_cast<int>(
+      ((TICK_UNITS - pacer.ahead) * BLEND_ONE + TICK_UNITS / 2) / TICK_UNITS);
+  timing.input_time = now;
+  return timing;
+}
+
+void note_render(FramePacer &pacer, FrameTiming const &timing) {
+  std::uint32_t const queued = get_time_us() - timing.ready_time;
+  if (pacer.frames == 0)
+    return; // counted with the latency, which skips the first frame
+
+  pacer.queued_sum += queued;
+  if (queued > pacer.worst_queued) {
+    pacer.worst_queued = queued;
+  }
+}
+
+void note_present(FramePacer &pacer, FrameTiming const &timing) {
+  std::uint32_t const now = get_time_us();
+  std::uint32_t const interval = now - pacer.last_present;
+  std::uint32_t const latency = now - timing.input_time;
+  pacer.last_present = now;
+  pacer.ticks += timing.ticks;
+
+  if (pacer.frames++ == 0)
+    return; // the first frame includes startup
+
+  pacer.latency_sum += latency;
+  if (latency > pacer.worst_latency) {
+    pacer.worst_latency = latency;
+  }
+
+  pacer.interval_sum += interval;
+  pacer.interval_sum_sq += static_cast<double>(interval) * interval;
+  if (interval > pacer.worst_interval) {
+    pacer.worst_interval = interval;
+  }
+  if (interval > RETRACE_US * 3 / 2) {
+    pacer.missed++;
+  }
+}
+
+void print_pacing_report(FramePacer const &pacer) {
+  long const intervals = pacer.frames - 1;
+  if (intervals < 1)
+    return;
+
+  double const mean = pacer.interval_sum / intervals;
+  double const variance = pacer.interval_sum_sq / intervals - mean * mean;
+  double const jitter = variance > 0 ? std::sqrt(variance) : 0;
+
+  std::cout << "pacing: " << pacer.frames << " frames, " << pacer.ticks
+            << " ticks, " << pacer.missed << " missed retraces, "
+            << pacer.dropped_ticks << " ticks dropped, frame interval "
+            << mean / 1000 << " ms mean, " << jitter / 1000 << " ms jitter, "
+            << pacer.worst_interval / 1000.0 << " ms worst, input latency "
+            << pacer.latency_sum / intervals / 1000 << " ms mean, "
+            << pacer.worst_latency / 1000.0 << " ms worst, of which queued "
+            << pacer.queued_sum / intervals / 1000 << " ms mean, "
+            << pacer.worst_queued / 1000.0 << " ms worst\n";
+}
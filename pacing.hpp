@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Frame pacing
+ *
+ * The game simulates at a fixed TICK_RATE whatever the display does. Before
+ * each frame, the pacer runs as many ticks as it takes for the simulation to
+ * reach the present moment, up to MAX_CATCHUP_TICKS, and says how far between
+ * the last two ticks that moment is so the frame can be drawn there. A frame
+ * that runs no ticks just draws the same ticks at a later blend.
+ */
+
+#define TICK_RATE 70 // simulation ticks per second
+#define MAX_CATCHUP_TICKS 4
+
+// A blend of BLEND_ONE draws the latest tick exactly
+#define BLEND_SHIFT 8
+#define BLEND_ONE (1 << BLEND_SHIFT)
+
+struct FrameTiming {
+  int ticks; // to simulate before drawing
+  int blend; // 0 draws the tick before the latest, BLEND_ONE the latest
+  std::uint32_t input_time; // when the frame was paced and its input read
+  std::uint32_t ready_time; // when its ticks were done and it was handed over
+};
+
+struct FramePacer {
+  std::uint32_t last_time;
+  long ahead; // simulated time past now, in microseconds * TICK_RATE
+
+  // For the report. pace_frame() touches separate fields from note_render()
+  // and note_present(), so the simulation and the renderer can each call
+  // theirs on its own thread.
+  std::uint32_t last_present;
+  long frames;
+  long ticks;
+  long dropped_ticks; // beyond MAX_CATCHUP_TICKS
+  long missed;        // frames that took longer than a retrace and a half
+  double interval_sum;
+  double interval_sum_sq;
+  std::uint32_t worst_interval;
+  double latency_sum; // from reading the input to presenting the frame
+  std::uint32_t worst_latency;
+  // The part of the latency the frame spent waiting for the renderer, which
+  // running the stages in turn on one thread wouldn't add
+  double queued_sum;
+  std::uint32_t worst_queued;
+};
+
+void start_pacing(FramePacer &pacer);
+
+// Says how many ticks to run before the next frame, and where to draw it
+FrameTiming pace_frame(FramePacer &pacer);
+
+// Call as the renderer takes the frame with the timing the simulation gave it
+void note_render(FramePacer &pacer, FrameTiming const &timing);
+
+// Call straight after show_buffer() with the timing of the frame it showed
+void note_present(FramePacer &pacer, FrameTiming const &timing);
+
+// Prints missed deadlines, frame interval jitter, input latency and how much
+// of it was spent queued to stdout
+void print_pacing_report(FramePacer const &pacer);
@@ -1,6 +1,13 @@
 #include "palettes.hpp"
 
-// TODO: these should be read from a file
+#include <cfloat>
+#include <cmath>
+
+#include "drawing.hpp"
+
+#define GAMMA ((float)2.2)
+
+// Built-in palettes, used when there is no asset pack (see assets.hpp)
 
 // TODO: support nonlinear interpolations
 
@@ -97,4 +104,33 @@ PaletteDef const palettes[] = {
 };
 // clang-format on
 
-int const NUM_PALETTES = sizeof(palettes) / sizeof(PaletteDef);
\ No newline at end of file
+int const NUM_PALETTES = sizeof(palettes) / sizeof(PaletteDef);
+
+void build_palette(PaletteDef const &pal_data, uint8_t *const rgb) {
+  for (int i = 0; i < pal_data.num_ranges; ++i) {
+    PaletteRange const &range = pal_data.ranges[i];
+    float const difference = range.last_index - range.first_index;
+
+    float working_red = std::pow(range.first_color.r, GAMMA);
+    float working_green = std::pow(range.first_color.g, GAMMA);
+    float working_blue = std::pow(range.first_color.b, GAMMA);
+
+    float const red_end = std::pow(range.last_color.r, GAMMA);
+    float const green_end = std::pow(range.last_color.g, GAMMA);
+    float const blue_end = std::pow(range.last_color.b, GAMMA);
+
+    float const red_inc = (red_end - working_red) / difference;
+    float const green_inc = (green_end - working_green) / difference;
+    float const blue_inc = (blue_end - working_blue) / difference;
+
+    for (int j = range.first_index; j <= range.last_index; j++) {
+      rgb[j * 3] = clamp_color(std::pow(working_red, 1 / GAMMA));
+      rgb[j * 3 + 1] = clamp_color(std::pow(working_green, 1 / GAMMA));
+      rgb[j * 3 + 2] = clamp_color(std::pow(working_blue, 1 / GAMMA));
+
+      working_red = clamp(working_red + red_inc, 0.f, FLT_MAX);
+      working_green = clamp(working_green + green_inc, 0.f, FLT_MAX);
+      working_blue = clamp(working_blue + blue_inc, 0.f, FLT_MAX);
+    }
+  }
+}
@@ -18,7 +18,6 @@ struct PaletteRange {
   PaletteColor last_color;
 };
 
-// TODO: read these from a file
 struct PaletteDef {
   // using the old static-sized approach since C++98 doesn't have initializer
   // lists
@@ -28,4 +27,8 @@ struct PaletteDef {
 };
 
 extern PaletteDef const palettes[];
-extern int const NUM_PALETTES;
\ No newline at end of file
+extern int const NUM_PALETTES;
+
+// Writes the gamma-corrected DAC values of each range to rgb, three bytes per
+// entry. Entries outside the ranges are left alone.
+void build_palette(PaletteDef const &pal_data, std::uint8_t *const rgb);
@@ -0,0 +1,206 @@
+#include "particle.hpp"
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tables.hpp"
+
+using std::uint8_t;
+
+// Bursts start at the nucleus and spread out, in quarter pixels
+#define BURST_RADIUS (8 * SCREEN_SCALE)
+#define BURST_MIN_GROWTH (2 * SCREEN_SCALE)
+#define BURST_GROWTH_RANGE (6 * SCREEN_SCALE)
+#define BURST_SWEEP_RANGE 16
+#define BURST_MIN_LIFE 16
+#define BURST_LIFE_RANGE 32
+
+// Bytes of every field for one particle
+#define PARTICLE_SIZE (2 * sizeof(uint8_t) + 3 * sizeof(std::int16_t))
+
+static long padded(long const count) {
+  return (count + PARTICLE_BLOCK - 1) / PARTICLE_BLOCK * PARTICLE_BLOCK;
+}
+
+void init_particles(ParticlePool &pool, int const num_orbiting,
+                    int const max_burst) {
+  // In long: PARTICLE_SIZE is a size_t, which is 16 bits on DOS
+  long const capacity = padded(static_cast<long>(num_orbiting) + max_burst);
+  long const size =
+      capacity * static_cast<long>(PARTICLE_SIZE) + PARTICLE_BLOCK;
+#ifndef PP_HOST
+  if (size > 0xFFFFL) {
+    std::cerr << "Too many particles to fit in 64K.\n";
+    std::exit(1);
+  }
+#endif
+
+  pool.storage = new uint8_t[static_cast<std::size_t>(size)];
+  if (pool.storage == NULL) {
+    std::cerr << "Not enough memory for particles.\n";
+    std::exit(1);
+  }
+  std::memset(pool.storage, 0, static_cast<std::size_t>(size));
+
+  uint8_t *next = pool.storage;
+#ifdef PP_HOST
+  next += (PARTICLE_BLOCK - reinterpret_cast<std::uintptr_t>(next) %
+                                PARTICLE_BLOCK) %
+          PARTICLE_BLOCK;
+#endif
+  // The widest fields go first so each array starts on a block boundary
+  pool.radius = reinterpret_cast<std::int16_t *>(next);
+  pool.growth = pool.radius + capacity;
+  pool.life = reinterpret_cast<std::uint16_t *>(pool.growth + capacity);
+  pool.phase = reinterpret_cast<uint8_t *>(pool.life + capacity);
+  pool.sweep = pool.phase + capacity;
+
+  pool.capacity = num_orbiting + max_burst;
+  pool.num_orbiting = num_orbiting;
+  reset_particles(pool, DEFAULT_SEED);
+}
+
+void free_particles(ParticlePool &pool) {
+  delete[] pool.storage;
+  pool.storage = NULL;
+  pool.capacity = pool.count = pool.num_orbiting = 0;
+}
+
+void copy_particles(ParticlePool &dest, ParticlePool const &src) {
+  assert(dest.capacity == src.capacity);
+
+  // Whole blocks, which is what the update and plot passes read
+  int const count = padded(src.count);
+  std::memcpy(dest.radius, src.radius, count * sizeof(std::int16_t));
+  std::memcpy(dest.growth, src.growth, count * sizeof(std::int16_t));
+  std::memcpy(dest.life, src.life, count * sizeof(std::uint16_t));
+  std::memcpy(dest.phase, src.phase, count);
+  std::memcpy(dest.sweep, src.sweep, count);
+
+  dest.count = src.count;
+  dest.num_orbiting = src.num_orbiting;
+  dest.burst_rnd = src.burst_rnd;
+}
+
+void reset_particles(ParticlePool &pool, std::uint32_t const seed) {
+  pool.count = pool.num_orbiting;
+  init_rnd(pool.burst_rnd, seed, kRndBurst);
+}
+
+void emit_burst(ParticlePool &pool, int const count) {
+  int const end = std::min(pool.count + count, pool.capacity);
+  std::uint32_t numbers[PARTICLE_BLOCK];
+  for (int i = pool.count; i < end; i++) {
+    int const batch = (i - pool.count) % PARTICLE_BLOCK;
+    if (batch == 0) {
+      fill_rnd(pool.burst_rnd, numbers,
+               std::min(end - i, static_cast<int>(PARTICLE_BLOCK)));
+    }
+    std::uint32_t const bits = numbers[batch];
+    pool.phase[i] = static_cast<uint8_t>(bits);
+    pool.sweep[i] = static_cast<uint8_t>((bits >> 8) % BURST_SWEEP_RANGE -
+                                         (BURST_SWEEP_RANGE >> 1));
+    pool.radius[i] = static_cast<std::int16_t>(BURST_RADIUS);
+    pool.growth[i] = static_cast<std::int16_t>(
+        BURST_MIN_GROWTH + (bits >> 16) % BURST_GROWTH_RANGE);
+    pool.life[i] = static_cast<std::uint16_t>(BURST_MIN_LIFE +
+                                              (bits >> 24) % BURST_LIFE_RANGE);
+  }
+  pool.count = end;
+}
+
+// Moves the live burst particles down over the expired ones
+static void remove_expired(ParticlePool &pool) {
+  int kept = pool.num_orbiting;
+  for (int i = pool.num_orbiting; i < pool.count; i++) {
+    if (!pool.life[i])
+      continue;
+
+    pool.phase[kept] = pool.phase[i];
+    pool.sweep[kept] = pool.sweep[i];
+    pool.radius[kept] = pool.radius[i];
+    pool.growth[kept] = pool.growth[i];
+    pool.life[kept] = pool.life[i];
+    kept++;
+  }
+  pool.count = kept;
+}
+
+void update_particles(ParticlePool &pool) {
+  // Orbiting particles have no growth, and their life counts down to 0 and
+  // stays there without being looked at
+#ifdef __SSE2__
+  int const end = padded(pool.count);
+  for (int i = 0; i < end; i += 16) {
+    __m128i *const phase = reinterpret_cast<__m128i *>(pool.phase + i);
+    __m128i const sweep =
+        _mm_load_si128(reinterpret_cast<__m128i const *>(pool.sweep + i));
+    _mm_store_si128(phase, _mm_add_epi8(_mm_load_si128(phase), sweep));
+  }
+
+  __m128i const one = _mm_set1_epi16(1);
+  for (int i = 0; i < end; i += 8) {
+    __m128i *const radius = reinterpret_cast<__m128i *>(pool.radius + i);
+    __m128i *const life = reinterpret_cast<__m128i *>(pool.life + i);
+    __m128i const growth =
+        _mm_load_si128(reinterpret_cast<__m128i const *>(pool.growth + i));
+    _mm_store_si128(radius, _mm_add_epi16(_mm_load_si128(radius), growth));
+    _mm_store_si128(life, _mm_subs_epu16(_mm_load_si128(life), one));
+  }
+#else
+  for (int i = 0; i < pool.count; i++) {
+    pool.phase[i] += pool.sweep[i];
+    pool.radius[i] += pool.growth[i];
+    if (pool.life[i])
+      pool.life[i]--;
+  }
+#endif
+
+  if (pool.count > pool.num_orbiting) {
+    remove_expired(pool);
+  }
+}
+
+void plot_particles(ParticlePool const &pool, Fixed const ball_x,
+                    Fixed const ball_y, PointSet &points) {
+  clear_points(points);
+
+  for (int start = 0; start < pool.count; start += PARTICLE_BLOCK) {
+    int const size = std::min(pool.count - start, PARTICLE_BLOCK);
+
+    int xs[PARTICLE_BLOCK], ys[PARTICLE_BLOCK];
+    int min_x = INT_MAX, max_x = INT_MIN, min_y = INT_MAX, max_y = INT_MIN;
+    for (int i = 0; i < size; i++) {
+      SinCos const angle = sincos_table[pool.phase[start + i]];
+      // Quarter pixels times a sine with 14 fraction bits is 16.16
+      Fixed const r = pool.radius[start + i];
+      xs[i] = fixed_to_int(ball_x + r * angle.cos);
+      ys[i] = fixed_to_int(ball_y + r * angle.sin);
+      min_x = std::min(min_x, xs[i]);
+      max_x = std::max(max_x, xs[i]);
+      min_y = std::min(min_y, ys[i]);
+      max_y = std::max(max_y, ys[i]);
+    }
+
+    // Clipped a block at a time: the whole block is usually on screen
+    if (min_x >= 0 && max_x <= MAX_X && min_y >= 0 && max_y <= MAX_Y) {
+      for (int i = 0; i < size; i++) {
+        add_point(points, xs[i], ys[i]);
+      }
+    } else if (max_x >= 0 && min_x <= MAX_X && max_y >= 0 && min_y <= MAX_Y) {
+      for (int i = 0; i < size; i++) {
+        if (IS_ONSCREEN(xs[i], ys[i]))
+          add_point(points, xs[i], ys[i]);
+      }
+    }
+  }
+
+  bin_points(points);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+#include "drawlist.hpp"
+#include "fixed.hpp"
+#include "rnd.hpp"
+
+/*
+ * Particles
+ *
+ * The nebula is a pool of particles circling the ball, kept as one array per
+ * field so a frame's update is a few straight passes over contiguous memory,
+ * 16 particles at a time with SSE2. The first num_orbiting particles circle
+ * for ever; the rest come in bursts, drift outwards and expire.
+ */
+
+#define PARTICLE_BLOCK 16 // arrays are padded to whole blocks and aligned
+
+struct ParticlePool {
+  int capacity;
+  int count;
+  int num_orbiting; // at the front, never expire
+
+  std::uint8_t *phase;  // angle around the ball
+  std::uint8_t *sweep;  // change of angle each frame
+  std::int16_t *radius; // distance from the ball in quarter pixels
+  std::int16_t *growth; // change of radius each frame
+  std::uint16_t *life;  // frames left, for burst particles
+
+  Rnd burst_rnd; // bursts have their own stream
+  std::uint8_t *storage;
+};
+
+// Room for num_orbiting plus max_burst more
+void init_particles(ParticlePool &pool, int const num_orbiting,
+                    int const max_burst);
+void free_particles(ParticlePool &pool);
+
+// Copies every particle of src into dest, which must have the same capacity
+void copy_particles(ParticlePool &dest, ParticlePool const &src);
+
+// Drops every burst and restarts the bursts' stream from seed. The caller sets
+// up the orbiting particles.
+void reset_particles(ParticlePool &pool, std::uint32_t const seed);
+
+// Adds up to count particles at the ball, as many as there is room for
+void emit_burst(ParticlePool &pool, int const count);
+
+void update_particles(ParticlePool &pool);
+
+// Clears points and adds the onscreen particles around the ball, then bins them
+void plot_particles(ParticlePool const &pool, Fixed const ball_x,
+                    Fixed const ball_y, PointSet &points);
@@ -0,0 +1,144 @@
+#include "pipeline.hpp"
+
+#include "system.hpp"
+
+static ProduceFunc g_produce;
+static void *g_context;
+static int g_depth;
+
+#ifdef PP_HOST
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ * Frames are numbered from 0. The producer fills frame n into slot
+ * n % PIPELINE_SLOTS and then publishes g_produced = n + 1; the consumer
+ * publishes g_released the same way. Each counter has one writer, and storing
+ * it orders the slot's contents before it.
+ *
+ * A side that has to wait yields a few times first, which is usually enough,
+ * then sleeps on the condition variable. Publishing only takes the mutex when
+ * someone is asleep; the counters and g_sleepers are sequentially consistent
+ * so a waiter either sees the new count or is seen sleeping.
+ */
+
+#define WAIT_SPINS 64
+
+static std::thread g_thread;
+static std::atomic<unsigned long> g_produced;
+static std::atomic<unsigned long> g_released;
+static std::atomic<bool> g_is_finished;
+static std::atomic<int> g_sleepers;
+static unsigned long g_acquired; // consumer only
+
+static std::mutex g_mutex;
+static std::condition_variable g_changed;
+
+static void notify() {
+  if (g_sleepers == 0)
+    return;
+
+  // Taking the lock makes sure the sleeper is waiting, not about to
+  { std::lock_guard<std::mutex> lock(g_mutex); }
+  g_changed.notify_all();
+}
+
+template <typename Condition> static void wait_for(Condition const condition) {
+  for (int spin = 0; spin < WAIT_SPINS; spin++) {
+    if (condition())
+      return;
+    std::this_thread::yield();
+  }
+
+  std::unique_lock<std::mutex> lock(g_mutex);
+  g_sleepers++;
+  g_changed.wait(lock, condition);
+  g_sleepers--;
+}
+
+static void producer_main() {
+  bool is_more = true;
+  for (unsigned long frame = 0; is_more; frame++) {
+    wait_for([frame] {
+      return frame - g_released < static_cast<unsigned long>(g_depth);
+    });
+
+    is_more = g_produce(g_context, static_cast<int>(frame % PIPELINE_SLOTS));
+    g_produced = frame + 1;
+    g_is_finished = !is_more; // only once the last frame is there
+    notify();
+  }
+}
+
+void start_pipeline(ProduceFunc const produce, void *const context,
+                    int const depth) {
+  g_produce = produce;
+  g_context = context;
+  g_depth = depth < PIPELINE_SLOTS ? depth : PIPELINE_SLOTS;
+  g_produced = 0;
+  g_released = 0;
+  g_is_finished = false;
+  g_sleepers = 0;
+  g_acquired = 0;
+
+  if (g_depth > 0) {
+    g_thread = std::thread(producer_main);
+  }
+}
+
+int acquire_frame() {
+  if (g_depth == 0) {
+    if (g_is_finished)
+      return -1;
+    g_is_finished = !g_produce(g_context, 0);
+    return 0;
+  }
+
+  unsigned long const frame = g_acquired;
+  wait_for([frame] { return g_produced > frame || g_is_finished; });
+  if (g_produced <= frame)
+    return -1;
+
+  g_acquired++;
+  return static_cast<int>(frame % PIPELINE_SLOTS);
+}
+
+void release_frame() {
+  if (g_depth == 0)
+    return;
+
+  g_released = g_acquired;
+  notify();
+}
+
+void stop_pipeline() {
+  if (g_thread.joinable()) {
+    g_thread.join();
+  }
+}
+
+#else
+
+static bool g_is_finished;
+
+void start_pipeline(ProduceFunc const produce, void *const context, int) {
+  g_produce = produce;
+  g_context = context;
+  g_depth = 0;
+  g_is_finished = false;
+}
+
+int acquire_frame() {
+  if (g_is_finished)
+    return -1;
+  g_is_finished = !g_produce(g_context, 0);
+  return 0;
+}
+
+void release_frame() {}
+void stop_pipeline() {}
+
+#endif
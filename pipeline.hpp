@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ * Two-stage frame pipeline
+ *
+ * A producer fills frames into a ring of PIPELINE_SLOTS slots on its own
+ * thread and the caller's thread consumes them in order. The ring is a
+ * single-producer, single-consumer queue of two counters, so handing over a
+ * frame takes no lock; a side only sleeps when it has nothing to do.
+ *
+ * depth bounds how many frames the producer may have filled that the consumer
+ * hasn't released. At depth 1 the producer starts frame n only once frame
+ * n - 1 is released, as if the stages ran in turn on one thread. Depth 0 runs
+ * them in turn on one thread, which is all DOS builds do.
+ */
+
+#define PIPELINE_SLOTS 2
+
+// Fills slot with the next frame. Returns false once it has filled the last.
+typedef bool (*ProduceFunc)(void *context, int slot);
+
+void start_pipeline(ProduceFunc const produce, void *const context,
+                    int const depth);
+
+// Waits for the next frame and returns its slot, or -1 after the last
+int acquire_frame();
+
+// The consumer is done with the slot acquire_frame() last returned
+void release_frame();
+
+// Waits for the producer to finish
+void stop_pipeline();
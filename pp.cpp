@@ -29,539 +29,385 @@ SOFTWARE.
 
 #include <algorith> // <algorithm>
 #include <cassert>
-#include <cfloat>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <iostream>
 #include <memory>
 
+#include "arena.hpp"
+#include "assets.hpp"
+#include "blur.hpp"
 #include "drawing.hpp"
-#include "palettes.hpp"
+#include "effects.hpp"
+#include "game.hpp"
+#include "pacing.hpp"
+#include "pipeline.hpp"
+#include "profile.hpp"
+#include "replay.hpp"
+#include "rnd.hpp"
 #include "system.hpp"
+#include "tables.hpp"
+#include "workers.hpp"
 
 using std::uint8_t;
 
-/*
- * Configuration constants
- *
- * These will likely become settings/config files, command line args, etc.
- */
-
-// Gameplay
-#define START_SPEED 1.8
-#define SIDE_SPEED_FACTOR (1.0 / 8)
-
-#define COLLISION_THRESHOLD 15
-
-#define PADDLE_MARGIN_HIT 13
-#define HALF_PADDLE_HIT 18
-
-#define MAX_RAND_NUMS 1021
-
-#define QUIT (LMB + RMB)
-
-// Graphics
-#define SCORE_X 10
-#define SCORE_Y 10
-
-#define COUNTDOWN_X 154
-#define COUNTDOWN_Y 93
-#define COUNTDOWN_FRAMES 4
-
-#define PADDLE_MARGIN 10
-#define HALF_PADDLE 16
-
-#define NEBULA_PARTICLES 25
-#define WAVE_SEGMENTS 10
-
-#define DIM_AMOUNT 0.2
-#define GAMMA ((float)2.2)
-
-/*
- * Defined constants
- *
- * Changing these values would require code changes, name changes, or
- * tearing apart the fabric of reality.
- */
-
-#define TAU 6.2831853071795864
-
-#define MAX_WEIGHT 12
-#define NUM_ANGLES 256
-
-#define MOUSE_MARGIN ((PADDLE_MARGIN) + (HALF_PADDLE))
-#define MOUSE_X_RANGE ((SCREEN_WIDTH)-2 * (MOUSE_MARGIN))
-#define MOUSE_Y_RANGE ((SCREEN_HEIGHT)-2 * (MOUSE_MARGIN))
-
-#define MOUSE_X_SCALE (float(MOUSE_X_RANGE) / (SCREEN_WIDTH))
-#define MOUSE_Y_SCALE (float(MOUSE_Y_RANGE) / (SCREEN_HEIGHT))
-
 /*
  * Look-up tables
  */
 
-int rnd_tbl[MAX_RAND_NUMS];
-int next_rnd_index;
-
-inline int get_rnd() {
-  if (++next_rnd_index >= MAX_RAND_NUMS) {
-    next_rnd_index = 0;
-  }
-  return rnd_tbl[next_rnd_index];
-}
-
-void init_rnd() {
-  next_rnd_index = 0;
-  for (int i = 0; i < MAX_RAND_NUMS; i++) {
-    rnd_tbl[i] = std::rand();
-  }
-}
-
-double cos_table[NUM_ANGLES], sin_table[NUM_ANGLES];
-
-void fill_trig_tables() {
+#ifndef NDEBUG
+// Catches a tables.cpp that wasn't regenerated after tables.hpp changed
+bool check_tables() {
   for (int i = 0; i < NUM_ANGLES; i++) {
-    double const radians = TAU * i / NUM_ANGLES;
-    cos_table[i] = std::cos(radians);
-    sin_table[i] = std::sin(radians);
+    if (sincos_table[i].cos != cos_entry(i) ||
+        sincos_table[i].sin != sin_entry(i))
+      return false;
   }
-}
-
-unsigned short target_x[SCREEN_WIDTH];
-unsigned short target_y[SCREEN_HEIGHT];
 
-void fill_targets() {
-  for (int i = 0; i < SCREEN_WIDTH; i++) {
-    short target = ((i - MID_X) / 1.03) + MID_X;
-    if (target < (MID_X - 1))
-      ++target;
-    target_x[i] = clamp<short>(target, 0, SCREEN_WIDTH);
+  for (int i = 0; i < VGA_WIDTH; i++) {
+    if (vga_target_x[i] != target_x_entry(i, VGA_WIDTH))
+      return false;
   }
 
-  for (int i = 0; i < SCREEN_HEIGHT; i++) {
-    short target = (((i - MID_Y) / 1.03) + MID_Y);
-    if (i < (MID_Y - 1))
-      ++target;
-    target_y[i] = SCREEN_WIDTH * clamp<short>(target, 0, SCREEN_HEIGHT);
+  for (int i = 0; i < VGA_HEIGHT; i++) {
+    if (vga_target_y[i] != target_y_entry(i, VGA_WIDTH, VGA_HEIGHT))
+      return false;
   }
-}
-
-uint8_t weighted_averages[MAX_WEIGHT * MAX_COLOR];
 
-void fill_weighted_averages() {
-  for (int i = 0; i < (MAX_WEIGHT * MAX_COLOR); i++) {
-    // TODO: DIM_AMOUNT should be subtracted instead of divided maybe?
-    weighted_averages[i] = static_cast<uint8_t>(i / (MAX_WEIGHT + DIM_AMOUNT));
+  for (int i = 0; i < NUM_WEIGHTED_SUMS; i++) {
+    if (weighted_averages[i] != weighted_average_entry(i))
+      return false;
   }
+
+  return true;
 }
+#endif
 
 /*
- * Background effects
+ * Startup
  */
 
-typedef void (*EffectFunc)(uint8_t *const);
-
-void none(uint8_t *const) {}
-
-void wave_effect(uint8_t *const buffer) {
-  int y1 = get_rnd() % 60 + 60;
-  int const dx = SCREEN_WIDTH / WAVE_SEGMENTS;
-
-  for (int i = 0; i <= WAVE_SEGMENTS; i++) {
-    int const y2 = get_rnd() % 60 + 60;
-    line(buffer, i * dx, y1, i * dx + dx, y2, 128);
-    y1 = y2;
-  }
-}
-
-void dot_effect(uint8_t *const buffer) {
-  for (int i = 0; i < 8; i++) {
-    int const drop_x = get_rnd() % (SCREEN_WIDTH - 3);
-    int const drop_y = get_rnd() % (SCREEN_HEIGHT - 3);
-
-    // top-mid
-    set_pixel(buffer, drop_x + 1, drop_y, MAX_COLOR);
-
-    // middle row
-    set_pixels(buffer, drop_x, drop_y + 1, MAX_COLOR, 3);
-
-    // bottom mid
-    set_pixel(buffer, drop_x + 1, drop_y + 2, MAX_COLOR);
-  }
-}
-
-void line_effect(uint8_t *const buffer) {
-  line(buffer, get_rnd() % SCREEN_WIDTH, get_rnd() % SCREEN_HEIGHT,
-       get_rnd() % SCREEN_WIDTH, get_rnd() % SCREEN_HEIGHT,
-       static_cast<uint8_t>(get_rnd() % NUM_COLORS));
-}
-
-static EffectFunc const effects[] = {none, dot_effect, line_effect,
-                                     wave_effect};
-
-static int const NUM_EFFECTS = sizeof(effects) / sizeof(EffectFunc);
-
-inline EffectFunc choose_effect() { return effects[get_rnd() % NUM_EFFECTS]; }
-
-void set_palette(PaletteDef const &pal_data, bool &is_noisy) {
-  is_noisy = pal_data.is_noisy;
-
-  // TODO: maybe precalculate the palettes
-  for (int i = 0; i <= pal_data.num_ranges; ++i) {
-    PaletteRange const &range = pal_data.ranges[i];
-    float const difference = range.last_index - range.first_index;
-
-    float working_red = std::pow(range.first_color.r, GAMMA);
-    float working_green = std::pow(range.first_color.g, GAMMA);
-    float working_blue = std::pow(range.first_color.b, GAMMA);
-
-    float const red_end = std::pow(range.last_color.r, GAMMA);
-    float const green_end = std::pow(range.last_color.g, GAMMA);
-    float const blue_end = std::pow(range.last_color.b, GAMMA);
-
-    float const red_inc = (red_end - working_red) / difference;
-    float const green_inc = (green_end - working_green) / difference;
-    float const blue_inc = (blue_end - working_blue) / difference;
-
-    for (int j = range.first_index; j <= range.last_index; j++) {
-      set_pal_entry(static_cast<uint8_t>(j),
-                    clamp_color(std::pow(working_red, 1 / GAMMA)),
-                    clamp_color(std::pow(working_green, 1 / GAMMA)),
-                    clamp_color(std::pow(working_blue, 1 / GAMMA)));
+struct Options {
+  char const *record_path;
+  char const *replay_path;
+  char const *assets_path; // NULL for DEFAULT_PACK_PATH, if it exists
+  int num_particles;       // orbiting the ball; from the log when replaying
+  std::uint32_t seed;      // from the log when replaying
+  bool is_pipelined;       // simulate and render on separate threads
+  int num_feedbacks;       // 1 for only the zoom; from the log when replaying
+};
 
-      working_red = clamp(working_red + red_inc, 0.f, FLT_MAX);
-      working_green = clamp(working_green + green_inc, 0.f, FLT_MAX);
-      working_blue = clamp(working_blue + blue_inc, 0.f, FLT_MAX);
+// Takes the game's own options out of argv and leaves the rest for the
+// backend. Returns the new argc.
+int parse_options(int argc, char *argv[], Options &options) {
+  options.record_path = NULL;
+  options.replay_path = NULL;
+  options.assets_path = NULL;
+  options.num_particles = NEBULA_PARTICLES;
+  options.seed = DEFAULT_SEED;
+  options.is_pipelined = true;
+  options.num_feedbacks = NUM_FEEDBACKS;
+
+  int kept = 1;
+  for (int i = 1; i < argc; i++) {
+    bool const has_value = i + 1 < argc;
+
+    if (!std::strcmp(argv[i], "--record") && has_value) {
+      options.record_path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--replay") && has_value) {
+      options.replay_path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--assets") && has_value) {
+      options.assets_path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--particles") && has_value) {
+      options.num_particles = std::atoi(argv[++i]);
+      if (options.num_particles < 0) {
+        std::cerr << "--particles must be at least 0\n";
+        std::exit(1);
+      }
+    } else if (!std::strcmp(argv[i], "--pipeline") && has_value &&
+               (!std::strcmp(argv[i + 1], "on") ||
+                !std::strcmp(argv[i + 1], "off"))) {
+      options.is_pipelined = !std::strcmp(argv[++i], "on");
+    } else if (!std::strcmp(argv[i], "--feedback") && has_value &&
+               (!std::strcmp(argv[i + 1], "zoom") ||
+                !std::strcmp(argv[i + 1], "all"))) {
+      options.num_feedbacks =
+          !std::strcmp(argv[++i], "zoom") ? 1 : NUM_FEEDBACKS;
+    } else if (!std::strcmp(argv[i], "--seed") && has_value) {
+      options.seed =
+          static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 0));
+    } else {
+      argv[kept++] = argv[i];
     }
   }
+  argv[kept] = NULL;
+  return kept;
 }
 
-void blur(uint8_t *const front_buffer, uint8_t *const back_buffer,
-          bool const is_noisy) {
-  for (int y = 0; y < SCREEN_HEIGHT; y++) {
-    for (int x = 0; x < SCREEN_WIDTH; x++) {
-      int weighted_sum = 0;
-      int const index = target_y[y] + target_x[x];
-
-      // Center pixel gets 8x weight
-      weighted_sum += (back_buffer[index]) << 2;
-
-      // Top, bottom, left, right get 1x weight
-      weighted_sum += back_buffer[index + 1] << 1;
-      weighted_sum += back_buffer[index + SCREEN_WIDTH] << 1;
-
-      weighted_sum += back_buffer[index - 1] << 1;
-      weighted_sum += back_buffer[index - SCREEN_WIDTH] << 1;
-
-      int target_color = weighted_averages[weighted_sum];
-      if (is_noisy)
-        target_color = clamp(target_color + get_rnd() % 2 - 1, 0, MAX_COLOR);
-      set_pixel(front_buffer, x, y, static_cast<uint8_t>(target_color));
-    }
+void init(int argc, char *argv[], Options &options, uint8_t *&front_buffer,
+          uint8_t *&back_buffer) {
+  argc = parse_options(argc, argv, options);
+  if (!init_system(argc, argv)) {
+    std::exit(1);
   }
-}
 
-/*
- * Gameplay
- */
-
-void init(uint8_t *&front_buffer, uint8_t *&back_buffer) {
-  // allocate mem for the front_buffer
-  if ((front_buffer = new uint8_t[SCREEN_SIZE]) == NULL) {
-    std::cerr << "Not enough memory for front buffer.\n";
+  if (options.replay_path &&
+      !start_replay(options.replay_path, options.seed, options.num_feedbacks,
+                    options.num_particles)) {
     std::exit(1);
   }
 
-  if ((back_buffer = new uint8_t[SCREEN_SIZE]) == NULL) {
-    std::cerr << "Not enough memory for back buffer.\n";
+  if (options.record_path &&
+      !start_recording(options.record_path, options.seed,
+                       options.num_feedbacks, options.num_particles)) {
     std::exit(1);
   }
 
-  std::memset(front_buffer, 0, SCREEN_SIZE);
-  std::memset(back_buffer, 0, SCREEN_SIZE);
+  // The frame buffers and the blur's tables share one arena
+  start_arena(2 * frame_buffer_span() + blur_arena_size() +
+              view_arena_size(options.num_particles));
+  front_buffer = alloc_frame_buffer();
+  back_buffer = alloc_frame_buffer();
+
+  // Replays run as fast as they can with nothing on screen
+  if (!options.replay_path) {
+    if (!has_mouse()) {
+      std::cerr << "PlasmaPong requires a mouse.\n";
+      std::exit(1);
+    }
 
-  if (!has_mouse()) {
-    std::cerr << "PlasmaPong requires a mouse.\n";
-    std::exit(1);
+    if (!set_vga_mode()) {
+      std::cerr << "Unable to set 320x200x256 color mode\n";
+      std::exit(1);
+    }
   }
 
-  if (!set_vga_mode()) {
-    std::cerr << "Unable to set 320x200x256 color mode\n";
-    std::exit(1);
-  }
+  assert(check_tables());
+  load_assets(options.assets_path ? options.assets_path : DEFAULT_PACK_PATH,
+              options.assets_path != NULL);
 
-  fill_trig_tables();
-  fill_targets();
-  fill_weighted_averages();
+  init_blur();
 
-  // TODO: seed with time or a specified value
-  std::srand(15);
-  init_rnd();
+  start_workers(0);
 }
 
-struct GameData {
-  float ball_x;
-  float ball_y;
-  float ball_dx;
-  float ball_dy;
-  float speed;
-
-  EffectFunc curr_effect;
-  int score;
-  int countdown;
-
-  bool is_noisy;
-
-  struct {
-    // distance from center of ball
-    float r[NEBULA_PARTICLES];
+static char const *const state_names[kNumStates] = {"playing", "losing",
+                                                     "lost"};
 
-    // starting angle
-    uint8_t phase[NEBULA_PARTICLES];
-
-    // change of angle each frame
-    uint8_t sweep[NEBULA_PARTICLES];
-  } nebula;
+// What show_buffer() sent, to see which effects and states a present of only
+// the changes helps
+struct PresentTotals {
+  long frames;
+  double bytes;
 };
 
-void enter_play(GameData &g, MouseState const &) {
-  init_rnd();
-  set_palette(palettes[get_rnd() % NUM_PALETTES], g.is_noisy);
-
-  float const DIAG_START = START_SPEED / std::sqrt(2.0);
-
-  g.ball_x = MID_X;
-  g.ball_y = MID_Y;
-  g.ball_dx = (get_rnd() % 2) ? DIAG_START : -DIAG_START;
-  g.ball_dy = (get_rnd() % 2) ? DIAG_START : -DIAG_START;
-  g.speed = START_SPEED;
-  g.curr_effect = choose_effect();
-  g.score = 0;
-
-  for (int i = 0; i < NEBULA_PARTICLES; i++) {
-    g.nebula.r[i] = get_rnd() % 4 + 5;
-    g.nebula.phase[i] = static_cast<uint8_t>(get_rnd() % NUM_ANGLES);
-    // Take advantage of uint underflow to create complementary angles
-    g.nebula.sweep[i] = static_cast<uint8_t>(get_rnd() % 30 - 15);
-  }
-}
+PresentTotals present_totals[kNumStates][NUM_EFFECTS];
 
-enum Direction {
-  kForward = 1,
-  kReverse = -1,
-};
+void print_present_report() {
+  for (int state = 0; state < kNumStates; state++) {
+    for (int effect = 0; effect < NUM_EFFECTS; effect++) {
+      PresentTotals const &totals = present_totals[state][effect];
+      if (!totals.frames)
+        continue;
 
-void process_hit(GameData &g, float &front_delta, float &front_pos,
-                 int paddle_pos, float &side_delta, float const side_pos,
-                 float const mouse_pos, Direction const direction) {
-  // TODO: use the speed as an actual magnitude
-  g.speed += .05;
-  front_delta = g.speed * direction;
-  front_pos = paddle_pos + (paddle_pos - front_pos);
-  side_delta = g.speed * (side_pos - mouse_pos) * SIDE_SPEED_FACTOR;
-  set_palette(palettes[get_rnd() % NUM_PALETTES], g.is_noisy);
-  g.curr_effect = choose_effect();
-  g.score++;
+      double const bytes = totals.bytes / totals.frames;
+      std::cout << "present: " << state_names[state] << ", "
+                << effect_names[effect] << ": " << totals.frames
+                << " frames, " << bytes << " bytes/frame ("
+                << 100 * bytes / SCREEN_SIZE << "%)\n";
+    }
+  }
 }
 
-enum State {
-  kPlaying = 0,
-  kLosing,
-  kLost,
-  kNumStates,
-};
-
-typedef void (*EnterFn)(GameData &g, MouseState const &mouse);
-typedef State (*UpdateFn)(GameData &g, MouseState const &mouse);
-typedef void (*RenderFn)(uint8_t *buffer, GameData const &g,
-                         MouseState const &mouse);
-
-struct StateEntry {
-  EnterFn enter;
-  UpdateFn update;
-  RenderFn render_back;
-  RenderFn render_front;
-};
+void get_scaled_mouse_state(MouseState &mouse) {
+  PROFILE_SCOPE(kPhaseInput);
+  get_mouse_state(mouse);
 
-inline void apply_deltas(GameData &g) {
-  g.ball_x += g.ball_dx;
-  g.ball_y += g.ball_dy;
+  mouse.x = static_cast<int>(static_cast<long>(mouse.x) * MOUSE_X_RANGE /
+                            SCREEN_WIDTH) +
+            MOUSE_MARGIN;
+  mouse.y = static_cast<int>(static_cast<long>(mouse.y) * MOUSE_Y_RANGE /
+                            SCREEN_HEIGHT) +
+            MOUSE_MARGIN;
 
-  for (int i = 0; i < NEBULA_PARTICLES; i++) {
-    g.nebula.phase[i] += g.nebula.sweep[i];
-  }
+  assert_onscreen(mouse.x, mouse.y);
 }
 
-State update_play(GameData &g, MouseState const &mouse) {
-  apply_deltas(g);
-
-  bool is_out = false;
-
-  if (g.ball_x >= (SCREEN_WIDTH - PADDLE_MARGIN_HIT) ||
-      g.ball_x < PADDLE_MARGIN_HIT ||
-      g.ball_y >= (SCREEN_HEIGHT - PADDLE_MARGIN_HIT) ||
-      g.ball_y < PADDLE_MARGIN_HIT) {
-
-    is_out = true;
-
-    if (g.ball_x < PADDLE_MARGIN_HIT &&
-        g.ball_y > (mouse.y - HALF_PADDLE_HIT) &&
-        g.ball_y < (mouse.y + HALF_PADDLE_HIT)) {
-      // Left paddle hit
-      process_hit(g, g.ball_dx, g.ball_x, PADDLE_MARGIN_HIT, g.ball_dy,
-                  g.ball_y, mouse.y, kForward);
-      is_out = false;
-    } else if (g.ball_x > (SCREEN_WIDTH - PADDLE_MARGIN_HIT) &&
-               g.ball_y < (MAX_Y - (mouse.y - HALF_PADDLE_HIT)) &&
-               g.ball_y > (MAX_Y - (mouse.y + HALF_PADDLE_HIT))) {
-      // Right paddle hit
-      process_hit(g, g.ball_dx, g.ball_x, SCREEN_WIDTH - PADDLE_MARGIN_HIT,
-                  g.ball_dy, g.ball_y, MAX_Y - mouse.y, kReverse);
-      is_out = false;
-    } else if (g.ball_y < PADDLE_MARGIN_HIT &&
-               g.ball_x < (MAX_X - (mouse.x - HALF_PADDLE_HIT)) &&
-               g.ball_x > (MAX_X - (mouse.x + HALF_PADDLE_HIT))) {
-      // top paddle hit
-      process_hit(g, g.ball_dy, g.ball_y, PADDLE_MARGIN_HIT, g.ball_dx,
-                  g.ball_x, MAX_X - mouse.x, kForward);
-      is_out = false;
-    } else if (g.ball_y > (SCREEN_HEIGHT - PADDLE_MARGIN_HIT) &&
-               g.ball_x > (mouse.x - HALF_PADDLE_HIT) &&
-               g.ball_x < (mouse.x + HALF_PADDLE_HIT)) {
-      // bottom paddle hit
-      process_hit(g, g.ball_dy, g.ball_y, SCREEN_HEIGHT - PADDLE_MARGIN_HIT,
-                  g.ball_dx, g.ball_x, mouse.x, kReverse);
-      is_out = false;
-    }
+// Live sessions take the ticks to run from the pacer, replays from the log
+void get_input(MouseState &mouse, FrameTiming &timing, FramePacer &pacer,
+               bool const is_replay) {
+  if (!is_replay) {
+    timing = pace_frame(pacer);
+    get_scaled_mouse_state(mouse);
+  } else if (!replay_input(mouse, timing)) {
+    mouse.buttons = QUIT;
   }
 
-  return is_out ? kLosing : kPlaying;
+  record_input(mouse, timing);
 }
 
-void render_play_back(uint8_t *buffer, GameData const &g, MouseState const &) {
-  g.curr_effect(buffer);
-}
-
-void render_play_front(uint8_t *buffer, GameData const &g,
-                       MouseState const &mouse) {
-  draw_number(buffer, SCORE_X, SCORE_Y, g.score);
-
-  // draw paddles
-
-  // TOP
-  line(buffer, MAX_X - (mouse.x - HALF_PADDLE), PADDLE_MARGIN,
-       MAX_X - (mouse.x + HALF_PADDLE), PADDLE_MARGIN, MAX_COLOR);
-  // BOTTOM
-  line(buffer, mouse.x - HALF_PADDLE, SCREEN_HEIGHT - PADDLE_MARGIN,
-       mouse.x + HALF_PADDLE, SCREEN_HEIGHT - PADDLE_MARGIN, MAX_COLOR);
-  // LEFT
-  line(buffer, PADDLE_MARGIN, mouse.y - HALF_PADDLE, PADDLE_MARGIN,
-       mouse.y + HALF_PADDLE, MAX_COLOR);
-  // RIGHT
-  line(buffer, SCREEN_WIDTH - PADDLE_MARGIN, MAX_Y - (mouse.y - HALF_PADDLE),
-       SCREEN_WIDTH - PADDLE_MARGIN, MAX_Y - (mouse.y + HALF_PADDLE),
-       MAX_COLOR);
-
-  // Draw "nucleus"
-  for (int i = 0; i < 5; i++) {
-    line(buffer, (int)g.ball_x + get_rnd() % 6 - 3,
-         (int)g.ball_y + get_rnd() % 6 - 3, (int)g.ball_x + get_rnd() % 6 - 3,
-         (int)g.ball_y + get_rnd() % 6 - 3, 230);
-  }
-
-  // Draw nebula
-  for (int i = 0; i < NEBULA_PARTICLES; i++) {
-    int const x = g.ball_x + g.nebula.r[i] * cos_table[g.nebula.phase[i]];
-    int const y = g.ball_y + g.nebula.r[i] * sin_table[g.nebula.phase[i]];
-    set_pixel_clipped(buffer, x, y, MAX_COLOR);
+std::uint32_t frame_checksum(uint8_t const *const buffer) {
+  // FNV-1a
+  long const size = static_cast<long>(SCREEN_WIDTH) * SCREEN_HEIGHT;
+  std::uint32_t hash = 2166136261UL;
+  for (long i = 0; i < size; i++) {
+    hash = (hash ^ buffer[i]) * 16777619UL;
   }
+  return hash;
 }
 
-State update_losing(GameData &g, MouseState const &) {
-  apply_deltas(g);
-
-  if (g.ball_x < -18 || g.ball_x > (MAX_X + 18) || g.ball_y < -18 ||
-      g.ball_y > (MAX_Y + 18)) {
-    return kLost;
-  }
+// What the simulation hands the renderer each frame. The renderer only reads
+// it, so the simulation is free to work on the next one.
+struct Frame {
+  Game game;
+  MouseState mouse;
+  FrameTiming timing;
+};
 
-  return kLosing;
-}
+// The simulation stage's own state, touched only by simulate_frame()
+struct Simulation {
+  Game game;
+  MouseState mouse; // TODO: general input state?
+  FramePacer *pacer;
+  bool is_replay;
+  Frame frames[PIPELINE_SLOTS];
+};
 
-void enter_lost(GameData &g, MouseState const &) {
-  g.countdown = COUNTDOWN_FRAMES;
-}
+// Reads the input and runs the ticks for one frame. Returns false on the frame
+// that quits.
+bool simulate_frame(void *const context, int const slot) {
+  Simulation &sim = *static_cast<Simulation *>(context);
+  Frame &frame = sim.frames[slot];
 
-State update_lost(GameData &g, MouseState const &) {
-  g.countdown--;
-  if (g.countdown == 0) {
-    g.score--;
-    g.countdown = COUNTDOWN_FRAMES;
+  get_input(sim.mouse, frame.timing, *sim.pacer, sim.is_replay);
+  if (sim.mouse.buttons == QUIT) {
+    frame.mouse = sim.mouse;
+    return false;
   }
 
-  if (g.score < 0) {
-    return kPlaying;
+  for (int tick = 0; tick < frame.timing.ticks; tick++) {
+    run_tick(sim.game, sim.mouse);
   }
+  sim.game.g.blend = frame.timing.blend;
 
-  return kLost;
+  copy_game(frame.game, sim.game);
+  frame.mouse = sim.mouse;
+  frame.timing.ready_time = get_time_us();
+  return true;
 }
 
-void render_lost(uint8_t *buffer, GameData const &g, MouseState const &) {
-  draw_number(buffer, COUNTDOWN_X, COUNTDOWN_Y, g.score);
-}
-
-static const StateEntry state_table[kNumStates] = {
-    {enter_play, update_play, render_play_back, render_play_front}, // kPlaying
-    {NULL, update_losing, render_play_back, render_play_front},     // kLosing
-    {enter_lost, update_lost, NULL, render_lost},                   // kLost
-};
+int main(int argc, char *argv[]) {
+  uint8_t *front_buffer, *back_buffer;
+  Options options;
+  init(argc, argv, options, front_buffer, back_buffer);
+
+  bool const is_replay = options.replay_path != NULL;
+  long frames = 0;
+  // Wall time for the frame rate, since the CPU time is summed over the
+  // workers and the pipeline's producer
+  std::uint32_t const start_us = get_time_us();
+  std::clock_t const start = std::clock();
+
+  FramePacer pacer;
+  Simulation sim;
+  sim.pacer = &pacer;
+  sim.is_replay = is_replay;
+
+  init_game(sim.game, options.num_particles);
+  for (int i = 0; i < PIPELINE_SLOTS; i++) {
+    init_game(sim.frames[i].game, options.num_particles);
+  }
+  start_game(sim.game, options.seed, options.num_feedbacks);
 
-void get_scaled_mouse_state(MouseState &mouse) {
-  get_mouse_state(mouse);
+  GameView view;
+  init_view(view, options.num_particles, options.seed);
 
-  mouse.x = mouse.x * MOUSE_X_SCALE + MOUSE_MARGIN;
-  mouse.y = mouse.y * MOUSE_Y_SCALE + MOUSE_MARGIN;
+  int shown_palette = -1;
 
-  assert_onscreen(mouse.x, mouse.y);
-}
+  start_pacing(pacer);
+  start_profile();
 
-int main() {
-  uint8_t *front_buffer, *back_buffer;
-  init(front_buffer, back_buffer);
+  // A live frame's input is read once the frame before it is shown, as it
+  // would be on one thread, so latency is unchanged but live play gets no
+  // overlap: everything the renderer draws depends on the ticks just run.
+  // Running the simulation a frame ahead would cost a retrace of latency,
+  // which the pacing report would show as time queued. Replays have no
+  // display to wait for and let the simulation run a frame ahead.
+  int depth = is_replay ? PIPELINE_SLOTS : 1;
+  if (!options.is_pipelined) {
+    depth = 0;
+  }
+  start_pipeline(simulate_frame, &sim, depth);
 
-  GameData g;
-  MouseState mouse; // TODO: general input state?
+  for (int slot = acquire_frame(); slot >= 0; slot = acquire_frame()) {
+    Frame const &frame = sim.frames[slot];
+    if (frame.mouse.buttons == QUIT)
+      break;
 
-  State state = kPlaying;
-  enter_play(g, mouse);
+    PROFILE_SCOPE(kPhaseFrame);
+    GameData const &g = frame.game.g;
 
-  for (get_scaled_mouse_state(mouse); mouse.buttons != QUIT;
-       get_scaled_mouse_state(mouse)) {
-    State const new_state = state_table[state].update(g, mouse);
+    if (!is_replay) {
+      note_render(pacer, frame.timing);
+    }
+    render_game(view, frame.game, frame.mouse, front_buffer, back_buffer);
 
-    if (new_state != state) {
-      state = new_state;
+    if (!is_replay) {
+      PROFILE_SCOPE(kPhaseShow);
 
-      if (state_table[state].enter) {
-        state_table[state].enter(g, mouse);
+      // Palette changes go out in the same retrace as the frame
+      uint8_t const *palette = NULL;
+      if (g.palette != shown_palette) {
+        PROFILE_COUNT(kCountPaletteUploads);
+        palette = palette_bank + g.palette * PALETTE_SIZE;
+        shown_palette = g.palette;
       }
-    }
+      long const sent = show_buffer(front_buffer, palette);
+      note_present(pacer, frame.timing);
 
-    if (state_table[state].render_back) {
-      state_table[state].render_back(back_buffer, g, mouse);
+      PresentTotals &totals =
+          present_totals[frame.game.state][effect_index(g.curr_effect)];
+      totals.frames++;
+      totals.bytes += sent;
     }
+    release_frame();
 
-    blur(front_buffer, back_buffer, g.is_noisy);
-
-    state_table[state].render_front(front_buffer, g, mouse);
-
-    show_buffer(front_buffer);
+    poll_profile();
     std::swap(front_buffer, back_buffer);
+    frames++;
   }
 
-  reset_mode();
+  stop_pipeline();
+  stop_recording();
+
+  if (is_replay) {
+    stop_replay();
+
+    double const seconds = (get_time_us() - start_us) / 1e6;
+    double const cpu_seconds =
+        static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    std::cout << "replay: " << frames << " frames in " << seconds << " s ("
+              << cpu_seconds << " s cpu), "
+              << (seconds > 0 ? frames / seconds : 0) << " frames/sec, "
+              << "checksum " << std::hex << frame_checksum(back_buffer)
+              << std::dec << "\n";
+  } else {
+    reset_mode();
+    print_pacing_report(pacer);
+    print_present_report();
+  }
+  print_profile();
+  stop_workers();
+  free_view(view);
+  free_game(sim.game);
+  for (int i = 0; i < PIPELINE_SLOTS; i++) {
+    free_game(sim.frames[i].game);
+  }
+  unload_assets();
+  stop_arena();
 
   return 0;
 }
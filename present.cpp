@@ -0,0 +1,93 @@
+#include "present.hpp"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "system.hpp"
+
+using std::uint8_t;
+
+static bool is_same_block(uint8_t const *const a, uint8_t const *const b) {
+#if defined(__SSE2__)
+  __m128i const low =
+      _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(a)),
+                     _mm_loadu_si128(reinterpret_cast<__m128i const *>(b)));
+  __m128i const high = _mm_cmpeq_epi8(
+      _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + 16)),
+      _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + 16)));
+  return _mm_movemask_epi8(_mm_and_si128(low, high)) == 0xFFFF;
+#elif defined(PP_HOST)
+  return !std::memcmp(a, b, PRESENT_BLOCK);
+#else
+  // A dword at a time, which the 386 and up compare in one instruction
+  std::uint32_t const *const x = (std::uint32_t const *)a;
+  std::uint32_t const *const y = (std::uint32_t const *)b;
+  for (int i = 0; i < PRESENT_BLOCK / 4; i++) {
+    if (x[i] != y[i])
+      return false;
+  }
+  return true;
+#endif
+}
+
+// With no video, only counts
+static void send(uint8_t *const video, uint8_t *const shadow,
+                 uint8_t const *const frame, long const start,
+                 long const size) {
+  if (!video)
+    return;
+
+  std::memcpy(video + start, frame + start, size);
+  if (shadow != video) {
+    std::memcpy(shadow + start, frame + start, size);
+  }
+}
+
+static long present(uint8_t *const video, uint8_t *const shadow,
+                    uint8_t const *const frame, long const size) {
+  long const budget = size / 100 * FULL_PRESENT_PERCENT;
+
+  long sent = 0;
+  long run_start = -1; // of the changed blocks not sent yet
+  for (long i = 0; i < size; i += PRESENT_BLOCK) {
+    long const block = size - i < PRESENT_BLOCK ? size - i : PRESENT_BLOCK;
+    bool const is_same = block == PRESENT_BLOCK
+                             ? is_same_block(frame + i, shadow + i)
+                             : !std::memcmp(frame + i, shadow + i, block);
+
+    if (!is_same) {
+      if (run_start < 0) {
+        run_start = i;
+      }
+      if (sent + (i + block - run_start) > budget) {
+        // Too much has changed to be worth comparing the rest
+        send(video, shadow, frame, run_start, size - run_start);
+        return sent + size - run_start;
+      }
+    } else if (run_start >= 0) {
+      send(video, shadow, frame, run_start, i - run_start);
+      sent += i - run_start;
+      run_start = -1;
+    }
+  }
+
+  if (run_start >= 0) {
+    send(video, shadow, frame, run_start, size - run_start);
+    sent += size - run_start;
+  }
+  return sent;
+}
+
+long present_changes(uint8_t *const video, uint8_t *const shadow,
+                     uint8_t const *const frame, long const size) {
+  return present(video, shadow, frame, size);
+}
+
+long count_changes(uint8_t const *const shadow, uint8_t const *const frame,
+                   long const size) {
+  // Nothing is written to the shadow when there is no video
+  return present(NULL, const_cast<uint8_t *>(shadow), frame, size);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Dirty-block presents
+ *
+ * Writes to video memory are the slowest part of showing a frame on old
+ * hardware, and much of the screen is the same from one frame to the next.
+ * The frame is compared with a shadow of what video memory holds, a block at
+ * a time, and only runs of changed blocks are sent. Once more than
+ * FULL_PRESENT_PERCENT of the frame has changed the rest goes in one copy.
+ */
+
+#define PRESENT_BLOCK 32 // bytes compared at a time
+#define FULL_PRESENT_PERCENT 60
+
+// Copies the blocks of frame that differ from shadow to video and shadow, and
+// returns the bytes sent. shadow may be video if reading video memory is as
+// cheap as reading memory.
+long present_changes(std::uint8_t *const video, std::uint8_t *const shadow,
+                     std::uint8_t const *const frame, long const size);
+
+// The bytes present_changes() would send, without sending them. For a backend
+// that writes each frame to fresh memory but still wants the count.
+long count_changes(std::uint8_t const *const shadow,
+                   std::uint8_t const *const frame, long const size);
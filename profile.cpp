@@ -0,0 +1,161 @@
+#include "profile.hpp"
+
+#ifdef PP_PROFILE
+
+#include <algorith> // <algorithm>
+#include <cstdio>
+
+#include "system.hpp"
+
+#ifdef PP_HOST
+#include <chrono>
+#include <csignal>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER
+#endif
+#endif
+
+// Ticks below 2 * SUB_BUCKETS get a bucket each. Above that each power of two
+// is split into SUB_BUCKETS buckets.
+#define SUB_BITS 3
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define NUM_BUCKETS ((33 - SUB_BITS) * SUB_BUCKETS)
+
+struct Histogram {
+  unsigned long counts[NUM_BUCKETS];
+  unsigned long samples;
+  std::uint32_t max;
+};
+
+static Histogram g_histograms[kNumPhases];
+unsigned long profile_counters[kNumCounters];
+
+static char const *const phase_names[kNumPhases] = {
+    "frame", "input", "update", "render back", "render front", "blur", "show",
+};
+
+static char const *const counter_names[kNumCounters] = {
+    "paddle hits",
+    "palette uploads",
+    "effect choices",
+};
+
+#ifdef PP_HOST
+typedef std::chrono::steady_clock Clock;
+
+static volatile std::sig_atomic_t g_is_report_asked = 0;
+static Clock::time_point g_start_time;
+static unsigned long long g_start_ticks;
+
+static void ask_for_report(int) { g_is_report_asked = 1; }
+
+static unsigned long long read_ticks() {
+#ifdef HAS_CYCLE_COUNTER
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+std::uint32_t profile_clock() {
+  return static_cast<std::uint32_t>(read_ticks());
+}
+
+// Measured against the clock over the whole run
+static double ns_per_tick() {
+  double const ns =
+      std::chrono::duration<double, std::nano>(Clock::now() - g_start_time)
+          .count();
+  unsigned long long const ticks = read_ticks() - g_start_ticks;
+  return ticks ? ns / ticks : 1;
+}
+#else
+std::uint32_t profile_clock() { return get_time_us() * 1000; }
+
+static double ns_per_tick() { return 1; }
+#endif
+
+static int bucket_of(std::uint32_t value) {
+  int exponent = 0;
+  while (value >= 2 * SUB_BUCKETS) {
+    value >>= 1;
+    exponent++;
+  }
+  return exponent * SUB_BUCKETS + static_cast<int>(value);
+}
+
+// The largest value that lands in the bucket
+static double bucket_top(int const bucket) {
+  if (bucket < 2 * SUB_BUCKETS)
+    return bucket;
+
+  int const exponent = bucket / SUB_BUCKETS - 1;
+  double const mantissa = bucket % SUB_BUCKETS + SUB_BUCKETS + 1;
+  return mantissa * (1UL << exponent) - 1;
+}
+
+void add_profile_sample(ProfilePhase const phase, std::uint32_t const ticks) {
+  Histogram &histogram = g_histograms[phase];
+  histogram.counts[bucket_of(ticks)]++;
+  histogram.samples++;
+  if (ticks > histogram.max) {
+    histogram.max = ticks;
+  }
+}
+
+void start_profile() {
+#ifdef PP_HOST
+  g_start_time = Clock::now();
+  g_start_ticks = read_ticks();
+#ifdef SIGUSR1
+  std::signal(SIGUSR1, ask_for_report);
+#endif
+#endif
+}
+
+void poll_profile() {
+#ifdef PP_HOST
+  if (g_is_report_asked) {
+    g_is_report_asked = 0;
+    print_profile();
+  }
+#endif
+}
+
+static double percentile(Histogram const &histogram, int const percent) {
+  // The sample at this rank, counting from 1
+  unsigned long const rank = (histogram.samples * percent + 99) / 100;
+  unsigned long seen = 0;
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    seen += histogram.counts[i];
+    if (seen >= rank)
+      return std::min(bucket_top(i), static_cast<double>(histogram.max));
+  }
+  return histogram.max;
+}
+
+void print_profile() {
+  double const us_per_tick = ns_per_tick() / 1000;
+
+  std::printf("profile:          samples     p50 us     p99 us     max us\n");
+  for (int phase = 0; phase < kNumPhases; phase++) {
+    Histogram const &histogram = g_histograms[phase];
+    if (!histogram.samples)
+      continue;
+
+    std::printf("  %-12s %10lu %10.1f %10.1f %10.1f\n", phase_names[phase],
+                histogram.samples, percentile(histogram, 50) * us_per_tick,
+                percentile(histogram, 99) * us_per_tick,
+                histogram.max * us_per_tick);
+  }
+  for (int counter = 0; counter < kNumCounters; counter++) {
+    std::printf("  %-16s %lu\n", counter_names[counter],
+                profile_counters[counter]);
+  }
+  std::fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Frame profiler
+ *
+ * Build with -DPP_PROFILE to time each phase of the main loop. A scope's time
+ * goes into a fixed histogram per phase, with buckets an eighth of a power of
+ * two wide, so recording a sample is a few shifts and an increment with no
+ * allocation or locking: each phase is only timed on one thread. Without
+ * PP_PROFILE the macros are empty and nothing is compiled in.
+ *
+ * The report gives p50, p99 and max per phase, accurate to the bucket width,
+ * and the event counters. It is printed on exit, and on SIGUSR1 on hosts that
+ * have it.
+ */
+
+enum ProfilePhase {
+  kPhaseFrame, // a whole pass of the main loop
+  kPhaseInput,
+  kPhaseUpdate, // one tick
+  kPhaseRenderBack,
+  kPhaseRenderFront,
+  kPhaseBlur,
+  kPhaseShow,
+  kNumPhases,
+};
+
+enum ProfileCounter {
+  kCountPaddleHits,
+  kCountPaletteUploads,
+  kCountEffectChoices,
+  kNumCounters,
+};
+
+#ifdef PP_PROFILE
+
+// The cheapest clock there is: the cycle counter on x86 hosts, converted to
+// time only for the report. Wraps, so only take differences of nearby times.
+std::uint32_t profile_clock();
+
+void add_profile_sample(ProfilePhase const phase, std::uint32_t const ticks);
+
+extern unsigned long profile_counters[kNumCounters];
+
+void start_profile();
+
+// Prints the report if it was asked for since the last call
+void poll_profile();
+
+void print_profile();
+
+struct ProfileScope {
+  ProfilePhase phase;
+  std::uint32_t start;
+
+  explicit ProfileScope(ProfilePhase const phase_)
+      : phase(phase_), start(profile_clock()) {}
+  ~ProfileScope() { add_profile_sample(phase, profile_clock() - start); }
+};
+
+#define PROFILE_SCOPE(phase) ProfileScope const profile_scope_##phase(phase)
+#define PROFILE_COUNT(counter) (profile_counters[counter]++)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_COUNT(counter)
+
+inline void start_profile() {}
+inline void poll_profile() {}
+inline void print_profile() {}
+
+#endif
@@ -0,0 +1,232 @@
+#include "replay.hpp"
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "feedback.hpp"
+
+/*
+ * Header: "PPIN", a version byte, then the screen width, the screen height,
+ * the seed, how many feedback maps the game picked from and how many particles
+ * orbited the ball as varints. Mouse coordinates depend on the resolution, so
+ * a log only replays at the size it was recorded at.
+ *
+ * Each frame is:
+ *   varint  zigzag(x - previous x) << 2 | (timing changed) << 1 |
+ *           (buttons changed)
+ *   varint  zigzag(y - previous y)
+ *   varint  buttons, only if they changed
+ *   varint  ticks, then blend, only if either changed
+ *
+ * A mouse at rest on a steady display costs two bytes a frame. Logs before
+ * version 3 came from the old table of std::rand() numbers, which no longer
+ * exists, so they can't be played back. Version 3 logs have no feedback count
+ * and replay with only the zoom, which was all there was. Logs before version 5
+ * have no particle count and replay with the one asked for; they drew the
+ * nebula from the round's stream, so they replay the same moves under other
+ * palettes and effects.
+ */
+
+#define LOG_MAGIC "PPIN"
+#define LOG_MAGIC_SIZE 4
+#define LOG_VERSION 5
+#define OLDEST_LOG_VERSION 3
+
+static std::FILE *g_record_file = NULL;
+static std::FILE *g_replay_file = NULL;
+static MouseState g_previous;
+static FrameTiming g_previous_timing;
+
+static void write_varint(std::FILE *const file, unsigned long value) {
+  while (value >= 0x80) {
+    std::fputc(static_cast<int>((value & 0x7F) | 0x80), file);
+    value >>= 7;
+  }
+  std::fputc(static_cast<int>(value), file);
+}
+
+static bool read_varint(std::FILE *const file, unsigned long &value) {
+  value = 0;
+  for (int shift = 0; shift < 32; shift += 7) {
+    int const byte = std::fgetc(file);
+    if (byte == EOF)
+      return false;
+
+    value |= static_cast<unsigned long>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false; // too long to be one of ours
+}
+
+inline unsigned long zigzag(long const value) {
+  return value < 0 ? ((static_cast<unsigned long>(-(value + 1))) << 1) | 1
+                   : static_cast<unsigned long>(value) << 1;
+}
+
+inline long unzigzag(unsigned long const value) {
+  return (value & 1) ? -static_cast<long>(value >> 1) - 1
+                     : static_cast<long>(value >> 1);
+}
+
+static void reset_previous() {
+  g_previous.x = 0;
+  g_previous.y = 0;
+  g_previous.buttons = 0;
+  g_previous_timing.ticks = 1;
+  g_previous_timing.blend = BLEND_ONE;
+  g_previous_timing.input_time = 0;
+}
+
+bool start_recording(char const *const path, std::uint32_t const seed,
+                     int const num_feedbacks, int const num_particles) {
+  if ((g_record_file = std::fopen(path, "wb")) == NULL) {
+    std::cerr << "Unable to write input log " << path << "\n";
+    return false;
+  }
+
+  std::fwrite(LOG_MAGIC, 1, LOG_MAGIC_SIZE, g_record_file);
+  std::fputc(LOG_VERSION, g_record_file);
+  write_varint(g_record_file, SCREEN_WIDTH);
+  write_varint(g_record_file, SCREEN_HEIGHT);
+  write_varint(g_record_file, seed);
+  write_varint(g_record_file, static_cast<unsigned long>(num_feedbacks));
+  write_varint(g_record_file, static_cast<unsigned long>(num_particles));
+
+  reset_previous();
+  return true;
+}
+
+void record_input(MouseState const &mouse, FrameTiming const &timing) {
+  if (!g_record_file)
+    return;
+
+  bool const buttons_changed = mouse.buttons != g_previous.buttons;
+  bool const timing_changed = timing.ticks != g_previous_timing.ticks ||
+                              timing.blend != g_previous_timing.blend;
+
+  unsigned long const x_token =
+      (zigzag(static_cast<long>(mouse.x) - g_previous.x) << 2) |
+      (timing_changed ? 2 : 0) | (buttons_changed ? 1 : 0);
+
+  write_varint(g_record_file, x_token);
+  write_varint(g_record_file,
+               zigzag(static_cast<long>(mouse.y) - g_previous.y));
+  if (buttons_changed)
+    write_varint(g_record_file, static_cast<unsigned long>(mouse.buttons));
+  if (timing_changed) {
+    write_varint(g_record_file, static_cast<unsigned long>(timing.ticks));
+    write_varint(g_record_file, static_cast<unsigned long>(timing.blend));
+  }
+
+  g_previous = mouse;
+  g_previous_timing = timing;
+}
+
+void stop_recording() {
+  if (g_record_file) {
+    std::fclose(g_record_file);
+    g_record_file = NULL;
+  }
+}
+
+bool start_replay(char const *const path, std::uint32_t &seed,
+                  int &num_feedbacks, int &num_particles) {
+  if ((g_replay_file = std::fopen(path, "rb")) == NULL) {
+    std::cerr << "Unable to open input log " << path << "\n";
+    return false;
+  }
+
+  char magic[LOG_MAGIC_SIZE];
+  unsigned long width, height, log_seed;
+  unsigned long log_feedbacks = 1;
+  unsigned long log_particles = static_cast<unsigned long>(num_particles);
+  int version = -1;
+  if (std::fread(magic, 1, LOG_MAGIC_SIZE, g_replay_file) != LOG_MAGIC_SIZE ||
+      std::memcmp(magic, LOG_MAGIC, LOG_MAGIC_SIZE) != 0 ||
+      (version = std::fgetc(g_replay_file)) < OLDEST_LOG_VERSION ||
+      version > LOG_VERSION || !read_varint(g_replay_file, width) ||
+      !read_varint(g_replay_file, height) ||
+      !read_varint(g_replay_file, log_seed) ||
+      (version >= 4 && !read_varint(g_replay_file, log_feedbacks)) ||
+      (version >= 5 && !read_varint(g_replay_file, log_particles))) {
+    std::cerr << path << " is not a version " << LOG_VERSION
+              << " input log\n";
+    stop_replay();
+    return false;
+  }
+
+  if (width != static_cast<unsigned long>(SCREEN_WIDTH) ||
+      height != static_cast<unsigned long>(SCREEN_HEIGHT)) {
+    std::cerr << path << " was recorded at " << width << "x" << height
+              << "\n";
+    stop_replay();
+    return false;
+  }
+
+  if (log_feedbacks < 1 || log_feedbacks > NUM_FEEDBACKS) {
+    std::cerr << path << " needs " << log_feedbacks
+              << " feedback maps, and this build has " << NUM_FEEDBACKS
+              << "\n";
+    stop_replay();
+    return false;
+  }
+
+  if (log_particles > static_cast<unsigned long>(INT_MAX)) {
+    std::cerr << path << " has " << log_particles
+              << " particles, more than this build can count\n";
+    stop_replay();
+    return false;
+  }
+
+  seed = static_cast<std::uint32_t>(log_seed);
+  num_feedbacks = static_cast<int>(log_feedbacks);
+  num_particles = static_cast<int>(log_particles);
+  reset_previous();
+  return true;
+}
+
+bool replay_input(MouseState &mouse, FrameTiming &timing) {
+  if (!g_replay_file)
+    return false;
+
+  unsigned long x_token, y_token;
+  if (!read_varint(g_replay_file, x_token) ||
+      !read_varint(g_replay_file, y_token))
+    return false;
+
+  mouse.x = static_cast<int>(g_previous.x + unzigzag(x_token >> 2));
+  mouse.y = static_cast<int>(g_previous.y + unzigzag(y_token));
+  mouse.buttons = g_previous.buttons;
+  timing = g_previous_timing;
+
+  if (x_token & 1) {
+    unsigned long buttons;
+    if (!read_varint(g_replay_file, buttons))
+      return false;
+    mouse.buttons = static_cast<int>(buttons);
+  }
+
+  if (x_token & 2) {
+    unsigned long ticks, blend;
+    if (!read_varint(g_replay_file, ticks) ||
+        !read_varint(g_replay_file, blend) || ticks > MAX_CATCHUP_TICKS ||
+        blend > BLEND_ONE)
+      return false;
+    timing.ticks = static_cast<int>(ticks);
+    timing.blend = static_cast<int>(blend);
+  }
+
+  g_previous = mouse;
+  g_previous_timing = timing;
+  return true;
+}
+
+void stop_replay() {
+  if (g_replay_file) {
+    std::fclose(g_replay_file);
+    g_replay_file = NULL;
+  }
+}
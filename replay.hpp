@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include "pacing.hpp"
+#include "system.hpp"
+
+/*
+ * Input logs
+ *
+ * Besides the seed, the scaled mouse state is the only input to the game, so
+ * logging it each frame, with how many ticks the frame ran and where it was
+ * drawn, is enough to play a session back exactly. A log is a header followed
+ * by one record per frame, each a few varints holding the change from the
+ * previous frame.
+ */
+
+bool start_recording(char const *const path, std::uint32_t const seed,
+                     int const num_feedbacks, int const num_particles);
+void record_input(MouseState const &mouse, FrameTiming const &timing);
+void stop_recording();
+
+// Sets seed, num_feedbacks and num_particles to the ones the log was recorded
+// with. A log too old to say keeps the num_particles passed in.
+bool start_replay(char const *const path, std::uint32_t &seed,
+                  int &num_feedbacks, int &num_particles);
+
+// Returns false once the log runs out.
+bool replay_input(MouseState &mouse, FrameTiming &timing);
+void stop_replay();
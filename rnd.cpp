@@ -0,0 +1,45 @@
+#include "rnd.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+// SSE2 only multiplies the even lanes, so do the odd ones separately
+static inline __m128i multiply32(__m128i const a, std::uint32_t const b) {
+  __m128i const factor = _mm_set1_epi32(static_cast<int>(b));
+  __m128i const even = _mm_mul_epu32(a, factor);
+  __m128i const odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), factor);
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i mix32x4(__m128i x) {
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+  x = multiply32(x, 0x7feb352dUL);
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+  x = multiply32(x, 0x846ca68bUL);
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+  return x;
+}
+#endif
+
+void fill_rnd(Rnd &rnd, std::uint32_t *const numbers, int const count) {
+  int i = 0;
+
+#ifdef __SSE2__
+  __m128i const key = _mm_set1_epi32(static_cast<int>(rnd.key));
+  __m128i position =
+      _mm_add_epi32(_mm_set1_epi32(static_cast<int>(rnd.position)),
+                    _mm_set_epi32(3, 2, 1, 0));
+  for (; i + RND_BATCH <= count; i += RND_BATCH) {
+    __m128i const mixed =
+        mix32x4(_mm_xor_si128(mix32x4(_mm_add_epi32(position, key)), key));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(numbers + i), mixed);
+    position = _mm_add_epi32(position, _mm_set1_epi32(RND_BATCH));
+  }
+  rnd.position += static_cast<std::uint32_t>(i);
+#endif
+
+  for (; i < count; i++) {
+    numbers[i] = next_rnd32(rnd);
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Random numbers
+ *
+ * A counter-based generator: the n-th number of a stream is a hash of n and
+ * the stream's key, so there is no shared state to step through. Each
+ * subsystem draws from its own stream, keyed by the game's seed and a stream
+ * id, and can jump to any position or split off substreams, e.g. one per band
+ * or per thread, whose numbers don't depend on who draws them or in what
+ * order. A whole game is reproducible from its seed.
+ *
+ * The hash is two rounds of Chris Wellons' lowbias32, 32-bit math only, so it
+ * costs the same on the 386 as a 32-bit multiply or four.
+ */
+
+#define DEFAULT_SEED 15
+#define RND_BATCH 4 // numbers fill_rnd() makes at once with SSE2
+
+// Independent streams of the game. Reordering them changes every game.
+enum RndStreamId {
+  kRndRound,    // the simulation; restarts with each round
+  kRndBurst,    // the nebula's bursts
+  kRndEffect,   // the background effects
+  kRndNucleus,  // the nucleus' jitter
+  kRndDither,   // which dither each frame of a noisy palette gets
+  kRndBot,      // the autoplay bot's aim
+  kRndFeedback, // which feedback map each hit picks
+  kRndNebula,   // where the orbiting particles start, however many there are
+};
+
+struct Rnd {
+  std::uint32_t key;
+  std::uint32_t position; // of the next number
+};
+
+inline std::uint32_t mix32(std::uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352dUL;
+  x ^= x >> 15;
+  x *= 0x846ca68bUL;
+  x ^= x >> 16;
+  return x;
+}
+
+// The number at position in the stream with key
+inline std::uint32_t rnd_at(std::uint32_t const key,
+                            std::uint32_t const position) {
+  return mix32(mix32(position + key) ^ key);
+}
+
+inline void init_rnd(Rnd &rnd, std::uint32_t const seed,
+                     RndStreamId const stream) {
+  rnd.key = rnd_at(seed, stream);
+  rnd.position = 0;
+}
+
+inline void seek_rnd(Rnd &rnd, std::uint32_t const position) {
+  rnd.position = position;
+}
+
+// The index-th substream of parent, independent of it and of its siblings
+inline Rnd split_rnd(Rnd const &parent, std::uint32_t const index) {
+  Rnd rnd;
+  rnd.key = rnd_at(parent.key ^ 0x85EBCA6BUL, index);
+  rnd.position = 0;
+  return rnd;
+}
+
+inline std::uint32_t next_rnd32(Rnd &rnd) {
+  return rnd_at(rnd.key, rnd.position++);
+}
+
+// 0 to 32767, which fits an int everywhere
+inline int get_rnd(Rnd &rnd) {
+  return static_cast<int>(next_rnd32(rnd) >> 17);
+}
+
+// The next count numbers of the stream, RND_BATCH at a time where the host
+// has SSE2. The same numbers next_rnd32() would give.
+void fill_rnd(Rnd &rnd, std::uint32_t *const numbers, int const count);
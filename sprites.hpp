@@ -2,8 +2,17 @@
 
 #include <cstdint>
 
-#define DIGIT_WIDTH 5
-#define DIGIT_HEIGHT 7
-#define DIGIT_SIZE (DIGIT_WIDTH * DIGIT_HEIGHT)
+/*
+ * 5x7 font covering printable ASCII, one byte per row. Bit GLYPH_WIDTH - 1 is
+ * the leftmost pixel.
+ */
 
-extern std::uint8_t const digit_sprites[10][DIGIT_HEIGHT][DIGIT_WIDTH];
\ No newline at end of file
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+#define GLYPH_SPACING (GLYPH_WIDTH + 1)
+
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+
+extern std::uint8_t const font_glyphs[NUM_GLYPHS][GLYPH_HEIGHT];
@@ -1,10 +1,40 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
-#define SCREEN_WIDTH 320  // width in pixels of mode 0x13
-#define SCREEN_HEIGHT 200 // height in pixels of mode 0x13
-#define NUM_COLORS 256    // number of colors in mode 0x13
+// Anything that isn't the DOS target is a host build, which gets the headless
+// backend and the kernels that need a modern CPU.
+#ifndef __DOS__
+#define PP_HOST
+#endif
+
+#define VGA_WIDTH 320  // width in pixels of mode 0x13
+#define VGA_HEIGHT 200 // height in pixels of mode 0x13
+#define NUM_COLORS 256 // number of colors in mode 0x13
+#define REFRESH_RATE 70 // vertical refresh of mode 0x13 in Hz
+
+#ifdef PP_HOST
+// The headless backend picks the framebuffer size at startup
+#define MAX_SCREEN_WIDTH 3840
+#define MAX_SCREEN_HEIGHT 2160
+
+struct Resolution {
+  int width;
+  int height;
+  int scale; // whole multiple of mode 0x13 that game geometry is scaled by
+};
+
+extern Resolution g_resolution;
+
+#define SCREEN_WIDTH (g_resolution.width)
+#define SCREEN_HEIGHT (g_resolution.height)
+#define SCREEN_SCALE (g_resolution.scale)
+#else
+#define SCREEN_WIDTH VGA_WIDTH
+#define SCREEN_HEIGHT VGA_HEIGHT
+#define SCREEN_SCALE 1
+#endif
 
 #define SCREEN_SIZE (SCREEN_WIDTH * SCREEN_HEIGHT)
 #define MAX_COLOR_COMPONENT 63 // RGB components in the palette
@@ -12,14 +42,36 @@
 #define LMB 1
 #define RMB 2
 
+// Handles backend-specific command line options. Returns false if the
+// arguments are not understood.
+bool init_system(int argc, char *argv[]);
+
 bool set_vga_mode();
 void reset_mode();
 
-void show_buffer(std::uint8_t *const front_buffer);
+// Monotonic time in microseconds from an arbitrary start. It wraps after about
+// 71 minutes, so only differences mean anything.
+std::uint32_t get_time_us();
+
+// Returns at about time_us, or at once if it has passed, giving the CPU away
+// in the meantime instead of spinning where the backend can.
+void wait_until(std::uint32_t const time_us);
+
+// Shows the frame at the next vertical retrace, sleeping for most of the
+// wait. If palette isn't NULL, all NUM_COLORS of its RGB triples are uploaded
+// in the same retrace. Only the parts of the frame that changed are sent;
+// returns how many bytes were.
+long show_buffer(std::uint8_t *const front_buffer,
+                 std::uint8_t const *const palette = NULL);
 
 void set_pal_entry(std::uint8_t const index, std::uint8_t const red,
                    std::uint8_t const green, std::uint8_t const blue);
 
+// Uploads count RGB triples starting at entry first, using the DAC's
+// auto-increment instead of setting the index for each entry.
+void set_palette_block(std::uint8_t const first, int const count,
+                       std::uint8_t const *const rgb);
+
 bool has_mouse();
 
 struct MouseState {
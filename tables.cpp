@@ -0,0 +1,322 @@
+// Generated by gentabs.cpp from the *_entry() functions in tables.hpp.
+// Do not edit.
+
+#include "tables.hpp"
+
+// clang-format off
+
+SinCos const sincos_table[NUM_ANGLES] = {
+  {16384, 0}, {16379, 402}, {16364, 804}, {16340, 1205},
+  {16305, 1606}, {16261, 2006}, {16207, 2404}, {16143, 2801},
+  {16069, 3196}, {15986, 3590}, {15893, 3981}, {15791, 4370},
+  {15679, 4756}, {15557, 5139}, {15426, 5520}, {15286, 5897},
+  {15137, 6270}, {14978, 6639}, {14811, 7005}, {14635, 7366},
+  {14449, 7723}, {14256, 8076}, {14053, 8423}, {13842, 8765},
+  {13623, 9102}, {13395, 9434}, {13160, 9760}, {12916, 10080},
+  {12665, 10394}, {12406, 10702}, {12140, 11003}, {11866, 11297},
+  {11585, 11585}, {11297, 11866}, {11003, 12140}, {10702, 12406},
+  {10394, 12665}, {10080, 12916}, {9760, 13160}, {9434, 13395},
+  {9102, 13623}, {8765, 13842}, {8423, 14053}, {8076, 14256},
+  {7723, 14449}, {7366, 14635}, {7005, 14811}, {6639, 14978},
+  {6270, 15137}, {5897, 15286}, {5520, 15426}, {5139, 15557},
+  {4756, 15679}, {4370, 15791}, {3981, 15893}, {3590, 15986},
+  {3196, 16069}, {2801, 16143}, {2404, 16207}, {2006, 16261},
+  {1606, 16305}, {1205, 16340}, {804, 16364}, {402, 16379},
+  {0, 16384}, {-402, 16379}, {-804, 16364}, {-1205, 16340},
+  {-1606, 16305}, {-2006, 16261}, {-2404, 16207}, {-2801, 16143},
+  {-3196, 16069}, {-3590, 15986}, {-3981, 15893}, {-4370, 15791},
+  {-4756, 15679}, {-5139, 15557}, {-5520, 15426}, {-5897, 15286},
+  {-6270, 15137}, {-6639, 14978}, {-7005, 14811}, {-7366, 14635},
+  {-7723, 14449}, {-8076, 14256}, {-8423, 14053}, {-8765, 13842},
+  {-9102, 13623}, {-9434, 13395}, {-9760, 13160}, {-10080, 12916},
+  {-10394, 12665}, {-10702, 12406}, {-11003, 12140}, {-11297, 11866},
+  {-11585, 11585}, {-11866, 11297}, {-12140, 11003}, {-12406, 10702},
+  {-12665, 10394}, {-12916, 10080}, {-13160, 9760}, {-13395, 9434},
+  {-13623, 9102}, {-13842, 8765}, {-14053, 8423}, {-14256, 8076},
+  {-14449, 7723}, {-14635, 7366}, {-14811, 7005}, {-14978, 6639},
+  {-15137, 6270}, {-15286, 5897}, {-15426, 5520}, {-15557, 5139},
+  {-15679, 4756}, {-15791, 4370}, {-15893, 3981}, {-15986, 3590},
+  {-16069, 3196}, {-16143, 2801}, {-16207, 2404}, {-16261, 2006},
+  {-16305, 1606}, {-16340, 1205}, {-16364, 804}, {-16379, 402},
+  {-16384, 0}, {-16379, -402}, {-16364, -804}, {-16340, -1205},
+  {-16305, -1606}, {-16261, -2006}, {-16207, -2404}, {-16143, -2801},
+  {-16069, -3196}, {-15986, -3590}, {-15893, -3981}, {-15791, -4370},
+  {-15679, -4756}, {-15557, -5139}, {-15426, -5520}, {-15286, -5897},
+  {-15137, -6270}, {-14978, -6639}, {-14811, -7005}, {-14635, -7366},
+  {-14449, -7723}, {-14256, -8076}, {-14053, -8423}, {-13842, -8765},
+  {-13623, -9102}, {-13395, -9434}, {-13160, -9760}, {-12916, -10080},
+  {-12665, -10394}, {-12406, -10702}, {-12140, -11003}, {-11866, -11297},
+  {-11585, -11585}, {-11297, -11866}, {-11003, -12140}, {-10702, -12406},
+  {-10394, -12665}, {-10080, -12916}, {-9760, -13160}, {-9434, -13395},
+  {-9102, -13623}, {-8765, -13842}, {-8423, -14053}, {-8076, -14256},
+  {-7723, -14449}, {-7366, -14635}, {-7005, -14811}, {-6639, -14978},
+  {-6270, -15137}, {-5897, -15286}, {-5520, -15426}, {-5139, -15557},
+  {-4756, -15679}, {-4370, -15791}, {-3981, -15893}, {-3590, -15986},
+  {-3196, -16069}, {-2801, -16143}, {-2404, -16207}, {-2006, -16261},
+  {-1606, -16305}, {-1205, -16340}, {-804, -16364}, {-402, -16379},
+  {0, -16384}, {402, -16379}, {804, -16364}, {1205, -16340},
+  {1606, -16305}, {2006, -16261}, {2404, -16207}, {2801, -16143},
+  {3196, -16069}, {3590, -15986}, {3981, -15893}, {4370, -15791},
+  {4756, -15679}, {5139, -15557}, {5520, -15426}, {5897, -15286},
+  {6270, -15137}, {6639, -14978}, {7005, -14811}, {7366, -14635},
+  {7723, -14449}, {8076, -14256}, {8423, -14053}, {8765, -13842},
+  {9102, -13623}, {9434, -13395}, {9760, -13160}, {10080, -12916},
+  {10394, -12665}, {10702, -12406}, {11003, -12140}, {11297, -11866},
+  {11585, -11585}, {11866, -11297}, {12140, -11003}, {12406, -10702},
+  {12665, -10394}, {12916, -10080}, {13160, -9760}, {13395, -9434},
+  {13623, -9102}, {13842, -8765}, {14053, -8423}, {14256, -8076},
+  {14449, -7723}, {14635, -7366}, {14811, -7005}, {14978, -6639},
+  {15137, -6270}, {15286, -5897}, {15426, -5520}, {15557, -5139},
+  {15679, -4756}, {15791, -4370}, {15893, -3981}, {15986, -3590},
+  {16069, -3196}, {16143, -2801}, {16207, -2404}, {16261, -2006},
+  {16305, -1606}, {16340, -1205}, {16364, -804}, {16379, -402},
+};
+
+PixelOffset const vga_target_x[VGA_WIDTH] = {
+  5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+  17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 27,
+  28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+  40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 61, 62,
+  63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74,
+  75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86,
+  87, 88, 89, 90, 91, 92, 93, 94, 94, 95, 96, 97,
+  98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109,
+  110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121,
+  122, 123, 124, 125, 126, 127, 127, 128, 129, 130, 131, 132,
+  133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144,
+  145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156,
+  157, 158, 159, 159, 160, 160, 161, 162, 163, 164, 165, 166,
+  167, 168, 169, 170, 171, 172, 173, 174, 175, 176, 177, 178,
+  179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190,
+  191, 192, 193, 193, 194, 195, 196, 197, 198, 199, 200, 201,
+  202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213,
+  214, 215, 216, 217, 218, 219, 220, 221, 222, 223, 224, 225,
+  226, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236,
+  237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 248,
+  249, 250, 251, 252, 253, 254, 255, 256, 257, 258, 259, 260,
+  260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 270, 271,
+  272, 273, 274, 275, 276, 277, 278, 279, 280, 281, 282, 283,
+  284, 285, 286, 287, 288, 289, 290, 291, 292, 293, 293, 294,
+  295, 296, 297, 298, 299, 300, 301, 302, 303, 304, 305, 306,
+  307, 308, 309, 310, 311, 312, 313, 314,
+};
+
+PixelOffset const vga_target_y[VGA_HEIGHT] = {
+  960, 1280, 1600, 1920, 2240, 2560, 2880, 3200, 3520, 3840,
+  4160, 4480, 4800, 5120, 5440, 5760, 6080, 6400, 6720, 7040,
+  7360, 7680, 8000, 8320, 8640, 8960, 9280, 9600, 9920, 10240,
+  10560, 10880, 10880, 11200, 11520, 11840, 12160, 12480, 12800, 13120,
+  13440, 13760, 14080, 14400, 14720, 15040, 15360, 15680, 16000, 16320,
+  16640, 16960, 17280, 17600, 17920, 18240, 18560, 18880, 19200, 19520,
+  19840, 20160, 20480, 20800, 21120, 21440, 21440, 21760, 22080, 22400,
+  22720, 23040, 23360, 23680, 24000, 24320, 24640, 24960, 25280, 25600,
+  25920, 26240, 26560, 26880, 27200, 27520, 27840, 28160, 28480, 28800,
+  29120, 29440, 29760, 30080, 30400, 30720, 31040, 31360, 31680, 31680,
+  32000, 32000, 32320, 32640, 32960, 33280, 33600, 33920, 34240, 34560,
+  34880, 35200, 35520, 35840, 36160, 36480, 36800, 37120, 37440, 37760,
+  38080, 38400, 38720, 39040, 39360, 39680, 40000, 40320, 40640, 40960,
+  41280, 41600, 41920, 42240, 42560, 42560, 42880, 43200, 43520, 43840,
+  44160, 44480, 44800, 45120, 45440, 45760, 46080, 46400, 46720, 47040,
+  47360, 47680, 48000, 48320, 48640, 48960, 49280, 49600, 49920, 50240,
+  50560, 50880, 51200, 51520, 51840, 52160, 52480, 52800, 53120, 53120,
+  53440, 53760, 54080, 54400, 54720, 55040, 55360, 55680, 56000, 56320,
+  56640, 56960, 57280, 57600, 57920, 58240, 58560, 58880, 59200, 59520,
+  59840, 60160, 60480, 60800, 61120, 61440, 61760, 62080, 62400, 62720,
+};
+
+std::uint8_t const weighted_averages[NUM_WEIGHTED_SUMS] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+  3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5,
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6,
+  6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9,
+  9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 10, 10, 10, 10, 10, 10,
+  10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+  11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 13,
+  13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14,
+  14, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+  15, 15, 15, 15, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+  17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18,
+  18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19,
+  19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+  20, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 22, 22, 22,
+  22, 22, 22, 22, 22, 22, 22, 22, 22, 23, 23, 23, 23, 23, 23, 23,
+  23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+  24, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 26, 26,
+  26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 27, 27, 27, 27, 27, 27,
+  27, 27, 27, 27, 27, 27, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+  28, 28, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 30, 30,
+  30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 31, 31, 31, 31, 31,
+  31, 31, 31, 31, 31, 31, 31, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+  32, 32, 32, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 34,
+  34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 35, 35, 36, 36, 36, 36, 36, 36, 36, 36,
+  36, 36, 36, 36, 37, 37, 37, 37, 37, 37, 37, 37, 37, 37, 37, 37,
+  38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 39, 39, 39, 39,
+  39, 39, 39, 39, 39, 39, 39, 39, 40, 40, 40, 40, 40, 40, 40, 40,
+  40, 40, 40, 40, 40, 41, 41, 41, 41, 41, 41, 41, 41, 41, 41, 41,
+  41, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 43, 43, 43,
+  43, 43, 43, 43, 43, 43, 43, 43, 43, 44, 44, 44, 44, 44, 44, 44,
+  44, 44, 44, 44, 44, 45, 45, 45, 45, 45, 45, 45, 45, 45, 45, 45,
+  45, 45, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 47, 47,
+  47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 48, 48, 48, 48, 48, 48,
+  48, 48, 48, 48, 48, 48, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49,
+  49, 49, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 51,
+  51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 52, 52, 52, 52, 52,
+  52, 52, 52, 52, 52, 52, 52, 53, 53, 53, 53, 53, 53, 53, 53, 53,
+  53, 53, 53, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 55,
+  55, 55, 55, 55, 55, 55, 55, 55, 55, 55, 55, 55, 56, 56, 56, 56,
+  56, 56, 56, 56, 56, 56, 56, 56, 57, 57, 57, 57, 57, 57, 57, 57,
+  57, 57, 57, 57, 58, 58, 58, 58, 58, 58, 58, 58, 58, 58, 58, 58,
+  59, 59, 59, 59, 59, 59, 59, 59, 59, 59, 59, 59, 60, 60, 60, 60,
+  60, 60, 60, 60, 60, 60, 60, 60, 60, 61, 61, 61, 61, 61, 61, 61,
+  61, 61, 61, 61, 61, 62, 62, 62, 62, 62, 62, 62, 62, 62, 62, 62,
+  62, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 64, 64, 64,
+  64, 64, 64, 64, 64, 64, 64, 64, 64, 65, 65, 65, 65, 65, 65, 65,
+  65, 65, 65, 65, 65, 65, 66, 66, 66, 66, 66, 66, 66, 66, 66, 66,
+  66, 66, 67, 67, 67, 67, 67, 67, 67, 67, 67, 67, 67, 67, 68, 68,
+  68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 69, 69, 69, 69, 69, 69,
+  69, 69, 69, 69, 69, 69, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70,
+  70, 70, 70, 71, 71, 71, 71, 71, 71, 71, 71, 71, 71, 71, 71, 72,
+  72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 73, 73, 73, 73, 73,
+  73, 73, 73, 73, 73, 73, 73, 74, 74, 74, 74, 74, 74, 74, 74, 74,
+  74, 74, 74, 75, 75, 75, 75, 75, 75, 75, 75, 75, 75, 75, 75, 75,
+  76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 77, 77, 77, 77,
+  77, 77, 77, 77, 77, 77, 77, 77, 78, 78, 78, 78, 78, 78, 78, 78,
+  78, 78, 78, 78, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79,
+  80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 81, 81, 81,
+  81, 81, 81, 81, 81, 81, 81, 81, 81, 82, 82, 82, 82, 82, 82, 82,
+  82, 82, 82, 82, 82, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+  83, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 85, 85, 85,
+  85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 86, 86, 86, 86, 86, 86,
+  86, 86, 86, 86, 86, 86, 87, 87, 87, 87, 87, 87, 87, 87, 87, 87,
+  87, 87, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 89, 89,
+  89, 89, 89, 89, 89, 89, 89, 89, 89, 89, 90, 90, 90, 90, 90, 90,
+  90, 90, 90, 90, 90, 90, 90, 91, 91, 91, 91, 91, 91, 91, 91, 91,
+  91, 91, 91, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 93,
+  93, 93, 93, 93, 93, 93, 93, 93, 93, 93, 93, 94, 94, 94, 94, 94,
+  94, 94, 94, 94, 94, 94, 94, 95, 95, 95, 95, 95, 95, 95, 95, 95,
+  95, 95, 95, 95, 96, 96, 96, 96, 96, 96, 96, 96, 96, 96, 96, 96,
+  97, 97, 97, 97, 97, 97, 97, 97, 97, 97, 97, 97, 98, 98, 98, 98,
+  98, 98, 98, 98, 98, 98, 98, 98, 99, 99, 99, 99, 99, 99, 99, 99,
+  99, 99, 99, 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+  100, 101, 101, 101, 101, 101, 101, 101, 101, 101, 101, 101, 101, 102, 102, 102,
+  102, 102, 102, 102, 102, 102, 102, 102, 102, 103, 103, 103, 103, 103, 103, 103,
+  103, 103, 103, 103, 103, 104, 104, 104, 104, 104, 104, 104, 104, 104, 104, 104,
+  104, 105, 105, 105, 105, 105, 105, 105, 105, 105, 105, 105, 105, 105, 106, 106,
+  106, 106, 106, 106, 106, 106, 106, 106, 106, 106, 107, 107, 107, 107, 107, 107,
+  107, 107, 107, 107, 107, 107, 108, 108, 108, 108, 108, 108, 108, 108, 108, 108,
+  108, 108, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 110, 110,
+  110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 110, 111, 111, 111, 111, 111,
+  111, 111, 111, 111, 111, 111, 111, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  112, 112, 112, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 114,
+  114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 115, 115, 115, 115, 115,
+  115, 115, 115, 115, 115, 115, 115, 115, 116, 116, 116, 116, 116, 116, 116, 116,
+  116, 116, 116, 116, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117,
+  118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 119, 119, 119, 119,
+  119, 119, 119, 119, 119, 119, 119, 119, 120, 120, 120, 120, 120, 120, 120, 120,
+  120, 120, 120, 120, 120, 121, 121, 121, 121, 121, 121, 121, 121, 121, 121, 121,
+  121, 122, 122, 122, 122, 122, 122, 122, 122, 122, 122, 122, 122, 123, 123, 123,
+  123, 123, 123, 123, 123, 123, 123, 123, 123, 124, 124, 124, 124, 124, 124, 124,
+  124, 124, 124, 124, 124, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125,
+  125, 125, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 127, 127,
+  127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 128, 128, 128, 128, 128, 128,
+  128, 128, 128, 128, 128, 128, 129, 129, 129, 129, 129, 129, 129, 129, 129, 129,
+  129, 129, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 131,
+  131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132,
+  132, 132, 132, 132, 132, 132, 132, 133, 133, 133, 133, 133, 133, 133, 133, 133,
+  133, 133, 133, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 135,
+  135, 135, 135, 135, 135, 135, 135, 135, 135, 135, 135, 135, 136, 136, 136, 136,
+  136, 136, 136, 136, 136, 136, 136, 136, 137, 137, 137, 137, 137, 137, 137, 137,
+  137, 137, 137, 137, 138, 138, 138, 138, 138, 138, 138, 138, 138, 138, 138, 138,
+  139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 140, 140, 140, 140,
+  140, 140, 140, 140, 140, 140, 140, 140, 140, 141, 141, 141, 141, 141, 141, 141,
+  141, 141, 141, 141, 141, 142, 142, 142, 142, 142, 142, 142, 142, 142, 142, 142,
+  142, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 144, 144, 144,
+  144, 144, 144, 144, 144, 144, 144, 144, 144, 145, 145, 145, 145, 145, 145, 145,
+  145, 145, 145, 145, 145, 145, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146,
+  146, 146, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 148, 148,
+  148, 148, 148, 148, 148, 148, 148, 148, 148, 148, 149, 149, 149, 149, 149, 149,
+  149, 149, 149, 149, 149, 149, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150,
+  150, 150, 150, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 152,
+  152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 153, 153, 153, 153, 153,
+  153, 153, 153, 153, 153, 153, 153, 154, 154, 154, 154, 154, 154, 154, 154, 154,
+  154, 154, 154, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155,
+  156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 157, 157, 157, 157,
+  157, 157, 157, 157, 157, 157, 157, 157, 158, 158, 158, 158, 158, 158, 158, 158,
+  158, 158, 158, 158, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159,
+  160, 160, 160, 160, 160, 160, 160, 160, 160, 160, 160, 160, 160, 161, 161, 161,
+  161, 161, 161, 161, 161, 161, 161, 161, 161, 162, 162, 162, 162, 162, 162, 162,
+  162, 162, 162, 162, 162, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163,
+  163, 164, 164, 164, 164, 164, 164, 164, 164, 164, 164, 164, 164, 165, 165, 165,
+  165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 166, 166, 166, 166, 166, 166,
+  166, 166, 166, 166, 166, 166, 167, 167, 167, 167, 167, 167, 167, 167, 167, 167,
+  167, 167, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 169, 169,
+  169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 170, 170, 170, 170, 170, 170,
+  170, 170, 170, 170, 170, 170, 170, 171, 171, 171, 171, 171, 171, 171, 171, 171,
+  171, 171, 171, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 173,
+  173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 174, 174, 174, 174, 174,
+  174, 174, 174, 174, 174, 174, 174, 175, 175, 175, 175, 175, 175, 175, 175, 175,
+  175, 175, 175, 175, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176,
+  177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 178, 178, 178, 178,
+  178, 178, 178, 178, 178, 178, 178, 178, 179, 179, 179, 179, 179, 179, 179, 179,
+  179, 179, 179, 179, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180,
+  180, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 182, 182, 182,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 183, 183, 183, 183, 183, 183, 183,
+  183, 183, 183, 183, 183, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184,
+  184, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 186, 186,
+  186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 187, 187, 187, 187, 187, 187,
+  187, 187, 187, 187, 187, 187, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188,
+  188, 188, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 190, 190,
+  190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 191, 191, 191, 191, 191,
+  191, 191, 191, 191, 191, 191, 191, 192, 192, 192, 192, 192, 192, 192, 192, 192,
+  192, 192, 192, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 194,
+  194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 195, 195, 195, 195, 195,
+  195, 195, 195, 195, 195, 195, 195, 195, 196, 196, 196, 196, 196, 196, 196, 196,
+  196, 196, 196, 196, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197,
+  198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 199, 199, 199, 199,
+  199, 199, 199, 199, 199, 199, 199, 199, 200, 200, 200, 200, 200, 200, 200, 200,
+  200, 200, 200, 200, 200, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201,
+  201, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 203, 203, 203,
+  203, 203, 203, 203, 203, 203, 203, 203, 203, 204, 204, 204, 204, 204, 204, 204,
+  204, 204, 204, 204, 204, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205,
+  205, 205, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 207, 207,
+  207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 208, 208, 208, 208, 208, 208,
+  208, 208, 208, 208, 208, 208, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209,
+  209, 209, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 211,
+  211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 212, 212, 212, 212, 212,
+  212, 212, 212, 212, 212, 212, 212, 213, 213, 213, 213, 213, 213, 213, 213, 213,
+  213, 213, 213, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 215,
+  215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 216, 216, 216, 216,
+  216, 216, 216, 216, 216, 216, 216, 216, 217, 217, 217, 217, 217, 217, 217, 217,
+  217, 217, 217, 217, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218,
+  219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 220, 220, 220, 220,
+  220, 220, 220, 220, 220, 220, 220, 220, 220, 221, 221, 221, 221, 221, 221, 221,
+  221, 221, 221, 221, 221, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222,
+  222, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 224, 224, 224,
+  224, 224, 224, 224, 224, 224, 224, 224, 224, 225, 225, 225, 225, 225, 225, 225,
+  225, 225, 225, 225, 225, 225, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226,
+  226, 226, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 228, 228,
+  228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 229, 229, 229, 229, 229, 229,
+  229, 229, 229, 229, 229, 229, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230,
+  230, 230, 230, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 232,
+  232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 233, 233, 233, 233, 233,
+  233, 233, 233, 233, 233, 233, 233, 234, 234, 234, 234, 234, 234, 234, 234, 234,
+  234, 234, 234, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235,
+  236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 237, 237, 237, 237,
+  237, 237, 237, 237, 237, 237, 237, 237, 238, 238, 238, 238, 238, 238, 238, 238,
+  238, 238, 238, 238, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239,
+  240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 241, 241, 241,
+  241, 241, 241, 241, 241, 241, 241, 241, 241, 242, 242, 242, 242, 242, 242, 242,
+  242, 242, 242, 242, 242, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243,
+  243, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 245, 245, 245,
+  245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 246, 246, 246, 246, 246, 246,
+  246, 246, 246, 246, 246, 246, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247,
+  247, 247, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 249, 249,
+  249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 250, 250, 250, 250, 250, 250,
+  250, 250, 250, 250, 250,
+};
+// clang-format on
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "drawing.hpp"
+#include "system.hpp"
+
+/*
+ * Look-up tables for blur() and the nebula.
+ *
+ * The tables themselves are generated ahead of time into tables.cpp by
+ * gentabs.cpp, so they are read-only data and startup doesn't compute them.
+ * The *_entry() functions below are the one definition of their contents,
+ * shared by the generator and the debug-build self-check.
+ *
+ * After changing anything here, regenerate with:
+ *
+ *   g++ -Ihost -o gentabs gentabs.cpp && ./gentabs > tables.cpp
+ */
+
+#define TAU 6.2831853071795864
+
+#define NUM_ANGLES 256
+
+#define ZOOM 1.03 // the blur pulls each pixel this much towards the center
+
+#define MAX_WEIGHT 12
+#define NUM_WEIGHTED_SUMS (MAX_WEIGHT * MAX_COLOR + 1)
+#define DIM_AMOUNT 0.2
+
+// cos and sin of each angle side by side, so one fetch gets both, in fixed
+// point with SINCOS_SHIFT fraction bits
+#define SINCOS_SHIFT 14
+
+struct SinCos {
+  std::int16_t cos;
+  std::int16_t sin;
+};
+
+extern SinCos const sincos_table[NUM_ANGLES];
+
+// Offsets into a frame buffer. 16 bits is all mode 0x13 needs, but larger host
+// resolutions overflow it.
+#ifdef PP_HOST
+typedef std::uint32_t PixelOffset;
+#else
+typedef unsigned short PixelOffset;
+#endif
+
+// Zoom targets for mode 0x13
+extern PixelOffset const vga_target_x[VGA_WIDTH];
+extern PixelOffset const vga_target_y[VGA_HEIGHT];
+
+// Zoom targets for the current resolution, set up by init_targets(). At
+// 320x200 these are the generated tables.
+extern PixelOffset const *target_x;
+extern PixelOffset const *target_y;
+
+extern std::uint8_t const weighted_averages[NUM_WEIGHTED_SUMS];
+
+inline std::int16_t cos_entry(int const i) {
+  return static_cast<std::int16_t>(
+      std::floor(std::cos(TAU * i / NUM_ANGLES) * (1 << SINCOS_SHIFT) + .5));
+}
+
+inline std::int16_t sin_entry(int const i) {
+  return static_cast<std::int16_t>(
+      std::floor(std::sin(TAU * i / NUM_ANGLES) * (1 << SINCOS_SHIFT) + .5));
+}
+
+inline PixelOffset target_x_entry(int const i, int const width) {
+  int const mid_x = width >> 1;
+  short target = ((i - mid_x) / ZOOM) + mid_x;
+  if (target < (mid_x - 1))
+    ++target;
+  return clamp<short>(target, 0, width);
+}
+
+inline PixelOffset target_y_entry(int const i, int const width,
+                                  int const height) {
+  int const mid_y = height >> 1;
+  short target = (((i - mid_y) / ZOOM) + mid_y);
+  if (i < (mid_y - 1))
+    ++target;
+  // At most the last row, so the row below it is the frame's guard
+  return static_cast<PixelOffset>(width) *
+         clamp<short>(target, 0, static_cast<short>(height - 1));
+}
+
+inline std::uint8_t weighted_average_entry(int const i) {
+  // TODO: DIM_AMOUNT should be subtracted instead of divided maybe?
+  return static_cast<std::uint8_t>(i / (MAX_WEIGHT + DIM_AMOUNT));
+}
@@ -0,0 +1,135 @@
+#include "workers.hpp"
+
+#include "system.hpp"
+
+#ifdef PP_HOST
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Each run_tasks() call is a "generation". Workers sleep until the generation
+ * changes, then claim task indices from a shared counter until they run out.
+ * The caller claims tasks too, then waits until every worker has checked in so
+ * that none of them can wander into the next generation's tasks. A task that
+ * calls run_tasks() itself runs the inner tasks in order on its own thread.
+ */
+
+static std::vector<std::thread> g_threads;
+static std::mutex g_mutex;
+static std::condition_variable g_wake;
+static std::condition_variable g_done;
+
+static unsigned long g_generation = 0;
+static bool g_stopping = false;
+
+static TaskFunc g_task;
+static void *g_context;
+static int g_count;
+static std::atomic<int> g_next_index;
+static int g_busy_workers;
+
+static thread_local bool t_is_in_task = false;
+
+static void claim_tasks() {
+  t_is_in_task = true;
+  for (int i = g_next_index++; i < g_count; i = g_next_index++) {
+    g_task(g_context, i);
+  }
+  t_is_in_task = false;
+}
+
+static void worker_main() {
+  unsigned long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(g_mutex);
+      while (!g_stopping && g_generation == seen) {
+        g_wake.wait(lock);
+      }
+      if (g_stopping)
+        return;
+      seen = g_generation;
+    }
+    claim_tasks();
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (--g_busy_workers == 0)
+      g_done.notify_one();
+  }
+}
+
+void start_workers(int count) {
+  if (count <= 0) {
+    char const *const env = std::getenv("PP_THREADS");
+    count = env ? std::atoi(env) : std::thread::hardware_concurrency();
+  }
+  if (count < 1)
+    count = 1;
+
+  g_stopping = false;
+  for (int i = 1; i < count; ++i) {
+    g_threads.push_back(std::thread(worker_main));
+  }
+}
+
+void stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_stopping = true;
+  }
+  g_wake.notify_all();
+
+  for (std::size_t i = 0; i < g_threads.size(); ++i) {
+    g_threads[i].join();
+  }
+  g_threads.clear();
+}
+
+int num_workers() { return static_cast<int>(g_threads.size()) + 1; }
+
+void run_tasks(TaskFunc const task, void *const context, int const count) {
+  if (g_threads.empty() || count <= 1 || t_is_in_task) {
+    for (int i = 0; i < count; ++i) {
+      task(context, i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_task = task;
+    g_context = context;
+    g_count = count;
+    g_next_index = 0;
+    g_busy_workers = static_cast<int>(g_threads.size());
+    ++g_generation;
+  }
+  g_wake.notify_all();
+
+  claim_tasks();
+
+  std::unique_lock<std::mutex> lock(g_mutex);
+  while (g_busy_workers > 0) {
+    g_done.wait(lock);
+  }
+}
+
+#else
+
+void start_workers(int) {}
+void stop_workers() {}
+
+int num_workers() { return 1; }
+
+void run_tasks(TaskFunc const task, void *const context, int const count) {
+  for (int i = 0; i < count; ++i) {
+    task(context, i);
+  }
+}
+
+#endif
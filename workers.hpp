@@ -0,0 +1,19 @@
+#pragma once
+
+// Persistent worker pool. Threads are started once and reused for every call
+// to run_tasks(). DOS builds have no threads and run the tasks in order.
+
+typedef void (*TaskFunc)(void *context, int index);
+
+// Starts count - 1 worker threads; the calling thread is the last worker.
+// count <= 0 picks one per core, overridden by the PP_THREADS environment
+// variable.
+void start_workers(int count);
+void stop_workers();
+
+int num_workers();
+
+// Calls task(context, i) for every i in [0, count) and returns once all of them
+// have finished. Tasks may run in any order and on any worker. Called from a
+// task, it runs them in order on that task's worker.
+void run_tasks(TaskFunc const task, void *const context, int const count);